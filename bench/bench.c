@@ -0,0 +1,971 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../photjson.h"
+
+#define BENCH_ROUNDS 10
+#define BENCH_MIN_SECONDS 0.1
+
+static const char *simd_names[] = {"scalar", "swar", "sse2", "sse4.2", "avx2"};
+
+// 使用进程的 CPU 时间，减少机器上其他负载的干扰
+static double now(void) { return (double)clock() / CLOCKS_PER_SEC; }
+
+// 多线程的基准测试只能用挂钟时间，CPU 时间会把各线程累加起来
+static double wall(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 生成由 count 个长度为 len 的字符串组成的数组，每 escape 个字符插入一个转义，0 表示不转义
+static char *gen_str_arr(size_t count, size_t len, size_t escape)
+{
+    char *json = (char *)malloc(count * (len * 2 + 3) + 3);
+    char *p = json;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            *p++ = ',';
+        }
+        *p++ = '"';
+        for (size_t j = 0; j < len; j++) {
+            if (escape > 0 && j % escape == escape - 1) {
+                *p++ = '\\';
+                *p++ = "nt\"\\"[j % 4];
+            } else {
+                *p++ = 'a' + (i + j) % 26;
+            }
+        }
+        *p++ = '"';
+    }
+    *p++ = ']';
+    *p = '\0';
+    return json;
+}
+
+// 生成 count 条结构相同的记录组成的压缩过的数组
+static char *gen_records(size_t count)
+{
+    char *json = (char *)malloc(count * 160 + 3);
+    char *p = json;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p,
+                     "%s{\"id\":%zu,\"name\":\"user%zu\",\"active\":%s,\"tags\":[\"a\",\"b\"],"
+                     "\"pos\":{\"x\":%zu.5,\"y\":-%zu},\"note\":null}",
+                     i > 0 ? "," : "", i, i, i % 2 ? "true" : "false", i % 1000, i % 77);
+    }
+    *p++ = ']';
+    *p = '\0';
+    return json;
+}
+
+// 按缩进 indent 个空格美化压缩过的 JSON
+static char *reindent(const char *json, int indent)
+{
+    char *out = (char *)malloc(strlen(json) * 8 + 1);
+    char *p = out;
+    int depth = 0;
+    bool in_str = false;
+    for (const char *s = json; *s != '\0'; s++) {
+        char ch = *s;
+        if (in_str) {
+            *p++ = ch;
+            if (ch == '\\') {
+                *p++ = *++s;
+            } else if (ch == '"') {
+                in_str = false;
+            }
+            continue;
+        }
+        switch (ch) {
+            case '"':
+                in_str = true;
+                *p++ = ch;
+                break;
+            case '[':
+            case '{':
+                *p++ = ch;
+                depth++;
+                *p++ = '\n';
+                p += sprintf(p, "%*s", depth * indent, "");
+                break;
+            case ']':
+            case '}':
+                depth--;
+                *p++ = '\n';
+                p += sprintf(p, "%*s", depth * indent, "");
+                *p++ = ch;
+                break;
+            case ',':
+                *p++ = ch;
+                *p++ = '\n';
+                p += sprintf(p, "%*s", depth * indent, "");
+                break;
+            case ':':
+                *p++ = ch;
+                *p++ = ' ';
+                break;
+            default:
+                *p++ = ch;
+        }
+    }
+    *p = '\0';
+    return out;
+}
+
+// 用文档模式反复解析，尽量排除分配器的影响，返回多轮中最好的 MB/s
+static double bench_parse_doc(const char *json)
+{
+    size_t len = strlen(json);
+    double best = 0.0;
+    phot_doc doc;
+    phot_doc_init(&doc);
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        size_t iters = 0;
+        double start = now(), elapsed;
+        do {
+            if (phot_parse_doc(&doc, json) != PHOT_PARSE_OK) {
+                fprintf(stderr, "parse failed\n");
+                exit(1);
+            }
+            iters++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        double mbps = len * iters / elapsed / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    phot_doc_free(&doc);
+    return best;
+}
+
+static void bench_str(void)
+{
+    static const struct {
+        const char *name;
+        size_t count, len, escape;
+    } corpora[] = {
+        {"short", 200000, 12, 0},
+        {"long", 1000, 4096, 0},
+        {"escape-heavy", 10000, 256, 8},
+    };
+    printf("string scanning (phot_parse_doc, MB/s)\n");
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        char *json = gen_str_arr(corpora[i].count, corpora[i].len, corpora[i].escape);
+        printf("  %-14s", corpora[i].name);
+        phot_simd best = phot_set_simd(PHOT_SIMD_AVX2);
+        for (int simd = PHOT_SIMD_SCALAR; simd <= (int)best; simd++) {
+            phot_set_simd((phot_simd)simd);
+            printf(" %s %8.1f", simd_names[simd], bench_parse_doc(json));
+        }
+        printf("\n");
+        free(json);
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+}
+
+// 生成 count 个数字组成的数组，数字按 format 格式化
+static char *gen_num_arr(size_t count, const char *format)
+{
+    char *json = (char *)malloc(count * 32 + 3);
+    char *p = json;
+    uint64_t state = 88172645463325252ULL;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (i > 0) {
+            *p++ = ',';
+        }
+        double d = (double)(state >> 11) / (1ULL << 53) * 2000000.0 - 1000000.0;
+        p += strchr(format, 'd') ? sprintf(p, format, (long)d) : sprintf(p, format, d);
+    }
+    *p++ = ']';
+    *p = '\0';
+    return json;
+}
+
+static void bench_num(void)
+{
+    static const struct {
+        const char *name, *format;
+    } corpora[] = {
+        {"integers", "%ld"},
+        {"decimals", "%.3f"},
+        {"doubles", "%.17g"},
+    };
+    printf("number parsing (phot_parse_doc, MB/s)\n");
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        char *json = gen_num_arr(200000, corpora[i].format);
+        printf("  %-14s %8.1f\n", corpora[i].name, bench_parse_doc(json));
+        free(json);
+    }
+}
+
+// 反复序列化同一个元素，返回多轮中最好的 MB/s（按输出长度计算）
+// 数值数组的内存占用：堆上解析的 MB/s，以及遍历求和时每个元素的纳秒数
+static void bench_num_tree(void)
+{
+    char *json = gen_num_arr(1000000, "%.3f");
+    size_t len = strlen(json);
+    printf("numeric array (1M decimals, %zu bytes per element)\n", sizeof(phot_elem));
+    double best_parse = 0.0, best_sum = 1e9, sink = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        phot_elem e;
+        phot_init(&e);
+        double start = now();
+        if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+        double mbps = len / (now() - start) / 1e6;
+        if (mbps > best_parse) {
+            best_parse = mbps;
+        }
+        size_t n = phot_get_arr_len(&e);
+        start = now();
+        for (int k = 0; k < 10; k++) {
+            for (size_t i = 0; i < n; i++) {
+                sink += phot_get_num(phot_get_arr_elem(&e, i));
+            }
+        }
+        double ns = (now() - start) / (10.0 * n) * 1e9;
+        if (ns < best_sum) {
+            best_sum = ns;
+        }
+        phot_free(&e);
+    }
+    printf("  phot_parse %8.1f MB/s  sum %6.2f ns per element%s\n", best_parse, best_sum, sink == 0.0 ? " " : "");
+    free(json);
+}
+
+// 统计字符串和键的总数，以及其中放不进元素、需要单独分配的个数
+static void count_strs(const phot_elem *e, size_t *total, size_t *heap)
+{
+    size_t i;
+    switch (phot_get_type(e)) {
+        case PHOT_STR:
+            ++*total;
+            *heap += (const char *)e != phot_get_str(e);
+            break;
+        case PHOT_ARR:
+            for (i = 0; i < phot_get_arr_len(e); i++) {
+                count_strs(phot_get_arr_elem(e, i), total, heap);
+            }
+            break;
+        case PHOT_OBJ:
+            for (i = 0; i < phot_get_obj_len(e); i++) {
+                ++*total;
+                *heap += phot_get_obj_key_len(e, i) > 12;
+                count_strs(phot_get_obj_value(e, i), total, heap);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// 短键和短字符串很多的记录：比较堆模式下解析、复制和释放的耗时
+static void bench_records_tree(void)
+{
+    char *json = gen_records(200000);
+    size_t len = strlen(json), total = 0, heap = 0;
+    printf("records (200k, heap DOM)\n");
+    double best_parse = 0.0, best_copy = 1e9, best_free = 1e9;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        phot_elem e, copy;
+        phot_init(&e);
+        phot_init(&copy);
+        double start = now();
+        if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+        double mbps = len / (now() - start) / 1e6;
+        if (mbps > best_parse) {
+            best_parse = mbps;
+        }
+        start = now();
+        phot_copy(&copy, &e);
+        double ms = (now() - start) * 1e3;
+        if (ms < best_copy) {
+            best_copy = ms;
+        }
+        if (round == 0) {
+            count_strs(&e, &total, &heap);
+        }
+        start = now();
+        phot_free(&e);
+        ms = (now() - start) * 1e3;
+        if (ms < best_free) {
+            best_free = ms;
+        }
+        phot_free(&copy);
+    }
+    printf("  phot_parse %8.1f MB/s  phot_copy %7.2f ms  phot_free %7.2f ms\n", best_parse, best_copy, best_free);
+    printf("  strings and keys %zu, heap allocated %zu\n", total, heap);
+    free(json);
+}
+
+// 深层嵌套的文档：外层数组中放 count 个 depth 层交替嵌套的数组和对象，每层还有一个数字
+static char *gen_deep(size_t count, size_t depth)
+{
+    char *json = (char *)malloc(count * depth * 12 + 3);
+    char *p = json;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            *p++ = ',';
+        }
+        for (size_t d = 0; d < depth; d++) {
+            p += sprintf(p, d % 2 == 0 ? "[%zu," : "{\"%zu\":", d % 10);
+        }
+        *p++ = '0';
+        for (size_t d = depth; d-- > 0;) {
+            *p++ = d % 2 == 0 ? ']' : '}';
+        }
+    }
+    *p++ = ']';
+    *p = '\0';
+    return json;
+}
+
+static void bench_deep(void)
+{
+    char *json = gen_deep(2000, 500);
+    size_t len = strlen(json);
+    printf("deep nesting (2000 x 500 levels, %.1f MB)\n", len / 1e6);
+    double best_parse = 1e9, best_stringify = 1e9, best_copy = 1e9, best_equal = 1e9, best_free = 1e9;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        phot_elem e, copy;
+        phot_init(&e);
+        phot_init(&copy);
+        double start = now();
+        if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+        double t = now() - start;
+        best_parse = t < best_parse ? t : best_parse;
+        start = now();
+        free(phot_stringify(&e, NULL));
+        t = now() - start;
+        best_stringify = t < best_stringify ? t : best_stringify;
+        start = now();
+        phot_copy(&copy, &e);
+        t = now() - start;
+        best_copy = t < best_copy ? t : best_copy;
+        start = now();
+        if (!phot_is_equal(&e, &copy)) {
+            fprintf(stderr, "copy differs\n");
+            exit(1);
+        }
+        t = now() - start;
+        best_equal = t < best_equal ? t : best_equal;
+        start = now();
+        phot_free(&e);
+        t = now() - start;
+        best_free = t < best_free ? t : best_free;
+        phot_free(&copy);
+    }
+    printf("  phot_parse %7.1f MB/s  phot_stringify %7.1f MB/s\n", len / best_parse / 1e6, len / best_stringify / 1e6);
+    printf("  phot_copy %7.2f ms  phot_is_equal %7.2f ms  phot_free %7.2f ms\n", best_copy * 1e3, best_equal * 1e3,
+           best_free * 1e3);
+    free(json);
+}
+
+// 固定词汇表里的长键反复出现的记录：比较堆模式下不驻留和共享驻留表时的解析与释放
+static void bench_intern(void)
+{
+    static const char *names[] = {"customer_identifier", "transaction_timestamp", "shipping_address_line",
+                                  "account_status_code", "preferred_currency", "last_login_ip_address"};
+    size_t count = 200000;
+    char *json = (char *)malloc(count * 200 + 3);
+    char *p = json;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p, "%s{", i > 0 ? "," : "");
+        for (size_t k = 0; k < 6; k++) {
+            p += sprintf(p, "%s\"%s\":%zu", k > 0 ? "," : "", names[k], i + k);
+        }
+        *p++ = '}';
+    }
+    *p++ = ']';
+    *p = '\0';
+    size_t len = p - json;
+    printf("long keys (200k records x 6 keys, heap DOM)\n");
+    phot_intern *keys = phot_intern_new(0);
+    for (int intern = 0; intern <= 1; intern++) {
+        double best_parse = 0.0, best_free = 1e9;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            phot_elem e;
+            phot_init(&e);
+            double start = now();
+            if (phot_parse_intern(&e, json, len, intern ? keys : NULL) != PHOT_PARSE_OK) {
+                fprintf(stderr, "parse failed\n");
+                exit(1);
+            }
+            double mbps = len / (now() - start) / 1e6;
+            if (mbps > best_parse) {
+                best_parse = mbps;
+            }
+            start = now();
+            phot_free(&e);
+            double ms = (now() - start) * 1e3;
+            if (ms < best_free) {
+                best_free = ms;
+            }
+        }
+        printf("  %-8s phot_parse %8.1f MB/s  phot_free %7.2f ms\n", intern ? "interned" : "plain", best_parse, best_free);
+    }
+    phot_intern_stats stats;
+    phot_intern_get_stats(keys, &stats);
+    printf("  %zu keys, hit rate %.4f, %.1f MB saved per parse\n", stats.keys, (double)stats.hits / stats.lookups,
+           stats.saved / 1e6 / BENCH_ROUNDS);
+    phot_intern_free(keys);
+    free(json);
+}
+
+// 大量小消息：每次新建解析栈和输出缓冲区，对比复用 phot_parser 和 phot_writer
+static void bench_reuse(void)
+{
+    char *json = gen_records(2);
+    size_t len = strlen(json), count = 500000;
+    printf("small messages (%zu x %zu bytes)\n", count, len);
+    phot_parser p;
+    phot_writer w;
+    phot_parser_init(&p);
+    phot_writer_init(&w);
+    phot_elem tree;
+    phot_init(&tree);
+    phot_parse_n(&tree, json, len);
+    for (int reuse = 0; reuse <= 1; reuse++) {
+        double best_parse = 1e9, best_stringify = 1e9;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            // 解析计入 phot_free，两种方式相同
+            double start = now();
+            for (size_t i = 0; i < count; i++) {
+                phot_elem e;
+                phot_init(&e);
+                int ret = reuse ? phot_parse_with(&p, &e, json, len) : phot_parse_n(&e, json, len);
+                if (ret != PHOT_PARSE_OK) {
+                    fprintf(stderr, "parse failed\n");
+                    exit(1);
+                }
+                phot_free(&e);
+            }
+            double parse = now() - start;
+            start = now();
+            for (size_t i = 0; i < count; i++) {
+                if (reuse) {
+                    phot_stringify_with(&w, &tree, NULL, NULL);
+                } else {
+                    free(phot_stringify(&tree, NULL));
+                }
+            }
+            double stringify = now() - start;
+            if (parse < best_parse) {
+                best_parse = parse;
+            }
+            if (stringify < best_stringify) {
+                best_stringify = stringify;
+            }
+        }
+        printf("  %-8s parse+free %7.1f ns/msg  stringify %7.1f ns/msg\n", reuse ? "reused" : "fresh",
+               best_parse / count * 1e9, best_stringify / count * 1e9);
+    }
+    phot_free(&tree);
+    phot_parser_free(&p);
+    phot_writer_free(&w);
+    free(json);
+}
+
+static double bench_stringify_ex(const phot_elem *e, const phot_stringify_opts *opts)
+{
+    double best = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        size_t iters = 0, len = 0;
+        double start = now(), elapsed;
+        do {
+            free(phot_stringify_ex(e, opts, &len));
+            iters++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        double mbps = len * iters / elapsed / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+static double bench_stringify(const phot_elem *e) { return bench_stringify_ex(e, NULL); }
+
+// 丢弃输出的回调，记下交给它的最大一段
+static bool null_write(void *ud, const char *buf, size_t len)
+{
+    size_t *max_chunk = (size_t *)ud;
+    (void)buf;
+    if (len > *max_chunk) {
+        *max_chunk = len;
+    }
+    return true;
+}
+
+// 生成 count 个约 len 字节的中文字符串，每 8 个字符夹一个空格，字符取自 test.in.json
+static char *gen_cjk_arr(size_t count, size_t len)
+{
+    static const char *chars[] = {"丁", "真", "珍", "珠", "四", "川", "甘", "孜", "理", "塘", "格", "聂", "镇", "然", "日", "卡", "村"};
+    char *json = (char *)malloc(count * (len + 8) + 3);
+    char *p = json;
+    *p++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p, "%s\"", i > 0 ? "," : "");
+        for (size_t j = 0; j * 3 < len; j++) {
+            p += sprintf(p, "%s", j % 9 == 8 ? " " : chars[(i + j) % 17]);
+        }
+        *p++ = '"';
+    }
+    *p++ = ']';
+    *p = '\0';
+    return json;
+}
+
+// 字符串转义的吞吐量，各指令集分别测量
+static void bench_stringify_str(void)
+{
+    static const struct {
+        const char *name;
+        size_t count, len, escape;
+    } corpora[] = {
+        {"short", 200000, 12, 0},
+        {"long", 1000, 4096, 0},
+        {"cjk", 1000, 4096, 0},
+        {"escape-heavy", 10000, 256, 8},
+    };
+    printf("string escaping (phot_stringify, MB/s)\n");
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        char *json = strcmp(corpora[i].name, "cjk") == 0 ? gen_cjk_arr(corpora[i].count, corpora[i].len)
+                                                         : gen_str_arr(corpora[i].count, corpora[i].len, corpora[i].escape);
+        phot_elem e;
+        phot_init(&e);
+        if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+        printf("  %-14s", corpora[i].name);
+        phot_simd best = phot_set_simd(PHOT_SIMD_AVX2);
+        for (int simd = PHOT_SIMD_SCALAR; simd <= (int)best; simd++) {
+            phot_set_simd((phot_simd)simd);
+            printf(" %s %8.1f", simd_names[simd], bench_stringify(&e));
+        }
+        printf("\n");
+        phot_free(&e);
+        free(json);
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+}
+
+// 整块输出和流式输出的吞吐量，以及各自需要的输出缓冲区
+static void bench_stringify_stream(void)
+{
+    char *json = gen_records(500000);
+    phot_elem e;
+    phot_init(&e);
+    if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+        fprintf(stderr, "parse failed\n");
+        exit(1);
+    }
+    size_t len = 0, max_chunk = 0;
+    double best_whole = bench_stringify(&e), best_stream = 0.0;
+    free(phot_stringify(&e, &len));
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        double start = now();
+        phot_stringify_to(&e, null_write, &max_chunk);
+        double mbps = len / (now() - start) / 1e6;
+        if (mbps > best_stream) {
+            best_stream = mbps;
+        }
+    }
+    printf("stringify records (%.1f MB output, MB/s)\n", len / 1e6);
+    printf("  phot_stringify    %8.1f  buffer %8.1f KB\n", best_whole, len / 1e3);
+    printf("  phot_stringify_to %8.1f  buffer %8.1f KB\n", best_stream, max_chunk / 1e3);
+    phot_free(&e);
+    free(json);
+}
+
+// 美化输出与紧凑输出的吞吐量，按各自输出的字节数计
+static void bench_stringify_pretty(void)
+{
+    static const struct {
+        const char *name;
+        phot_stringify_opts opts;
+    } formats[] = {
+        {"compact", {0, 0, false, false}},
+        {"indent 2", {2, ' ', false, true}},
+        {"indent tab", {1, '\t', false, true}},
+        {"indent 4 crlf", {4, ' ', true, true}},
+    };
+    char *json = gen_records(500000);
+    phot_elem e;
+    phot_init(&e);
+    if (phot_parse(&e, json) != PHOT_PARSE_OK) {
+        fprintf(stderr, "parse failed\n");
+        exit(1);
+    }
+    printf("stringify records with formatting (phot_stringify_ex, MB/s of output)\n");
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        size_t len;
+        free(phot_stringify_ex(&e, &formats[i].opts, &len));
+        printf("  %-14s %8.1f %8.1f MB\n", formats[i].name, bench_stringify_ex(&e, &formats[i].opts), len / 1e6);
+    }
+    phot_free(&e);
+    free(json);
+}
+
+static void bench_stringify_num(void)
+{
+    static const struct {
+        const char *name, *format;
+    } corpora[] = {
+        {"integers", "%ld"},
+        {"decimals", "%.3f"},
+        {"doubles", "%.17g"},
+    };
+    printf("number stringify (phot_stringify, MB/s of output, bytes per document)\n");
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        char *json = gen_num_arr(200000, corpora[i].format);
+        phot_elem e;
+        phot_init(&e);
+        phot_parse(&e, json);
+        size_t len;
+        free(phot_stringify(&e, &len));
+        printf("  %-14s %8.1f %10zu\n", corpora[i].name, bench_stringify(&e), len);
+        phot_free(&e);
+        free(json);
+    }
+}
+
+// 生成 count 个键的对象，键形如 "id123"
+static char *gen_wide_obj(size_t count)
+{
+    char *json = (char *)malloc(count * 32 + 3);
+    char *p = json;
+    *p++ = '{';
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p, i > 0 ? ",\"id%zu\":%zu" : "\"id%zu\":%zu", i * 7919 % count, i);
+    }
+    *p++ = '}';
+    *p = '\0';
+    return json;
+}
+
+// 逐个键查找一遍，返回每次查找的平均纳秒数
+static double bench_find(const phot_elem *obj)
+{
+    size_t len = phot_get_obj_len(obj), found = 0;
+    double best = 1e9;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        size_t iters = 0;
+        double start = now(), elapsed;
+        do {
+            for (size_t i = 0; i < len; i++) {
+                found += phot_find_obj_value(obj, phot_get_obj_key(obj, i), phot_get_obj_key_len(obj, i)) != NULL;
+            }
+            iters++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        double ns = elapsed * 1e9 / (iters * len);
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    if (found == 0) {
+        fprintf(stderr, "lookup failed\n");
+        exit(1);
+    }
+    return best;
+}
+
+static void bench_obj(void)
+{
+    static const size_t sizes[] = {8, 16, 64, 1000, 100000};
+    printf("object lookup (ns per phot_find_obj_value; ms to copy with phot_copy)\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char *json = gen_wide_obj(sizes[i]);
+        phot_elem e, copy;
+        phot_init(&e);
+        phot_init(&copy);
+        phot_parse(&e, json);
+        double start = now();
+        phot_copy(&copy, &e);
+        double copy_ms = (now() - start) * 1e3;
+        printf("  %-8zu find %8.1f  copy %9.2f\n", sizes[i], bench_find(&e), copy_ms);
+        phot_free(&copy);
+        phot_free(&e);
+        free(json);
+    }
+}
+
+// 同样的内容分别以压缩和美化的形式解析，比较每次解析的耗时
+static void bench_ws(void)
+{
+    char *minified = gen_records(20000);
+    char *pretty = reindent(minified, 4);
+    size_t min_len = strlen(minified), pretty_len = strlen(pretty);
+    printf("whitespace skipping (phot_parse_doc, ms per document; %.1f MB minified, %.1f MB pretty)\n", min_len / 1e6,
+           pretty_len / 1e6);
+    phot_simd best = phot_set_simd(PHOT_SIMD_AVX2);
+    for (int simd = PHOT_SIMD_SCALAR; simd <= (int)best; simd++) {
+        phot_set_simd((phot_simd)simd);
+        double min_ms = min_len / bench_parse_doc(minified) / 1e3;
+        double pretty_ms = pretty_len / bench_parse_doc(pretty) / 1e3;
+        printf("  %-7s minified %7.2f  pretty %7.2f\n", simd_names[simd], min_ms, pretty_ms);
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+    free(minified);
+    free(pretty);
+}
+
+// 逐字节识别结构与两阶段结构索引两种后端的对比
+static void bench_backend(void)
+{
+    if (phot_set_backend(PHOT_BACKEND_INDEX) != PHOT_BACKEND_INDEX) {
+        printf("parser backend: index backend not compiled, build with -DPHOT_USE_INDEX_BACKEND=1\n");
+        return;
+    }
+    char *records = gen_records(20000);
+    char *pretty = reindent(records, 4);
+    char *strs = gen_str_arr(1000, 4096, 0);
+    char *nums = gen_num_arr(200000, "%.17g");
+    const struct {
+        const char *name;
+        const char *json;
+    } corpora[] = {{"records", records}, {"pretty", pretty}, {"long-str", strs}, {"doubles", nums}};
+    printf("parser backend (phot_parse_doc, MB/s)\n");
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        phot_set_backend(PHOT_BACKEND_DESCENT);
+        double descent = bench_parse_doc(corpora[i].json);
+        phot_set_backend(PHOT_BACKEND_INDEX);
+        double index = bench_parse_doc(corpora[i].json);
+        printf("  %-9s descent %8.1f  index %8.1f\n", corpora[i].name, descent, index);
+    }
+    phot_set_backend(PHOT_BACKEND_DESCENT);
+    free(records);
+    free(pretty);
+    free(strs);
+    free(nums);
+}
+
+// 生成 count 个字段的宽记录，字段依次是字符串、数字和嵌套对象
+static char *gen_wide_record(size_t count)
+{
+    char *json = (char *)malloc(count * 96 + 3);
+    char *p = json;
+    *p++ = '{';
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p, "%s\"field%zu\":", i > 0 ? "," : "", i);
+        switch (i % 3) {
+            case 0:
+                p += sprintf(p, "\"some text value number %zu\"", i);
+                break;
+            case 1:
+                p += sprintf(p, "%zu.%03zue-2", i * 7919, i % 1000);
+                break;
+            default:
+                p += sprintf(p, "{\"x\":[%zu,%zu,%zu],\"s\":\"nested\",\"b\":true}", i, i + 1, i + 2);
+        }
+    }
+    *p++ = '}';
+    *p = '\0';
+    return json;
+}
+
+// 只读取少数字段时，文档模式与惰性文档的对比，返回多轮中最好的 MB/s
+static double bench_lazy_read(const char *json, bool lazy)
+{
+    static const char *const keys[] = {"field3", "field250", "field401", "field499"};
+    size_t len = strlen(json);
+    double best = 0.0, sink = 0.0;
+    phot_doc doc;
+    phot_doc_init(&doc);
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        size_t iters = 0;
+        double start = now(), elapsed;
+        do {
+            int ret = lazy ? phot_parse_lazy(&doc, json, len) : phot_parse_doc(&doc, json);
+            if (ret != PHOT_PARSE_OK) {
+                fprintf(stderr, "parse failed\n");
+                exit(1);
+            }
+            for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+                const phot_elem *v = phot_find_obj_value(phot_doc_root(&doc), keys[k], strlen(keys[k]));
+                sink += phot_get_type(v) == PHOT_NUM ? phot_get_num(v) : (double)phot_get_type(v);
+            }
+            iters++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        double mbps = len * iters / elapsed / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    phot_doc_free(&doc);
+    return sink != 0.0 ? best : 0.0;
+}
+
+static void bench_lazy(void)
+{
+    char *json = gen_wide_record(500);
+    printf("reading 4 of 500 fields (%.1f KB per record, MB/s)\n", strlen(json) / 1e3);
+    printf("  phot_parse_doc %8.1f  phot_parse_lazy %8.1f\n", bench_lazy_read(json, false), bench_lazy_read(json, true));
+    free(json);
+}
+
+static bool count_num(void *ud, double num)
+{
+    (void)num;
+    ++*(size_t *)ud;
+    return true;
+}
+
+// 只统计数字个数的事件解析与构建完整文档的对比
+static void bench_sax(void)
+{
+    char *json = gen_records(20000);
+    size_t len = strlen(json), count = 0;
+    phot_handler handler = {0};
+    handler.num = count_num;
+    double best = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        size_t iters = 0;
+        double start = now(), elapsed;
+        do {
+            if (phot_parse_sax(json, &handler, &count) != PHOT_PARSE_OK) {
+                fprintf(stderr, "parse failed\n");
+                exit(1);
+            }
+            iters++;
+        } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+        double mbps = len * iters / elapsed / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    printf("event parsing (records, MB/s)\n  phot_parse_sax %8.1f\n  phot_parse_doc %8.1f\n", best, bench_parse_doc(json));
+    free(json);
+}
+
+// 以 64 KB 为一块送入增量解析器，与一次性解析整个文档对比
+static void bench_stream(void)
+{
+    char *json = gen_records(20000);
+    size_t len = strlen(json);
+    double best[2] = {0.0, 0.0};
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int mode = 0; mode < 2; mode++) {
+            size_t iters = 0;
+            double start = now(), elapsed;
+            do {
+                phot_stream s;
+                phot_elem e;
+                if (mode == 0) {
+                    phot_init(&e);
+                    phot_parse(&e, json);
+                } else {
+                    phot_stream_init(&s, &e);
+                    for (size_t i = 0; i < len; i += 65536) {
+                        phot_stream_feed(&s, json + i, len - i < 65536 ? len - i : 65536);
+                    }
+                    phot_stream_finish(&s);
+                }
+                phot_free(&e);
+                iters++;
+            } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+            double mbps = len * iters / elapsed / 1e6;
+            if (mbps > best[mode]) {
+                best[mode] = mbps;
+            }
+        }
+    }
+    printf("incremental parsing (records, MB/s)\n  phot_parse        %8.1f\n  phot_stream_feed  %8.1f\n", best[0],
+           best[1]);
+    free(json);
+}
+
+static bool ndjson_ok(void *ud, size_t offset, int status, const phot_elem *e)
+{
+    (void)ud;
+    (void)offset;
+    (void)e;
+    return status == PHOT_PARSE_OK;
+}
+
+// 每行一条记录的 NDJSON，按线程数比较有序和无序交付的吞吐量
+static void bench_ndjson(void)
+{
+    size_t count = 500000;
+    char *json = (char *)malloc(count * 160);
+    char *p = json;
+    for (size_t i = 0; i < count; i++) {
+        p += sprintf(p,
+                     "{\"id\":%zu,\"name\":\"user%zu\",\"active\":%s,\"tags\":[\"a\",\"b\"],"
+                     "\"pos\":{\"x\":%zu.5,\"y\":-%zu},\"note\":null}\n",
+                     i, i, i % 2 ? "true" : "false", i % 1000, i % 77);
+    }
+    size_t len = p - json;
+    static const size_t threads[] = {1, 2, 4, 8, 16, 0};
+    printf("ndjson (%.1f MB, wall-clock MB/s; threads 0 = all CPUs)\n", len / 1e6);
+    double base = 0.0;
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        double best[2] = {0.0, 0.0};
+        for (int round = 0; round < 3; round++) {
+            for (int ordered = 0; ordered <= 1; ordered++) {
+                phot_ndjson_opts opts = {threads[i], ordered, NULL, NULL};
+                double start = wall();
+                if (phot_parse_ndjson(json, len, &opts, ndjson_ok, NULL) != PHOT_PARSE_OK) {
+                    fprintf(stderr, "parse failed\n");
+                    exit(1);
+                }
+                double mbps = len / (wall() - start) / 1e6;
+                if (mbps > best[ordered]) {
+                    best[ordered] = mbps;
+                }
+            }
+        }
+        if (i == 0) {
+            base = best[1];
+        }
+        printf("  threads %-3zu ordered %8.1f  unordered %8.1f  speedup %5.2fx\n", threads[i], best[1], best[0],
+               best[1] / base);
+    }
+    free(json);
+}
+
+int main(void)
+{
+    bench_str();
+    bench_ws();
+    bench_backend();
+    bench_num();
+    bench_num_tree();
+    bench_records_tree();
+    bench_deep();
+    bench_intern();
+    bench_reuse();
+    bench_stringify_num();
+    bench_stringify_str();
+    bench_stringify_stream();
+    bench_stringify_pretty();
+    bench_obj();
+    bench_lazy();
+    bench_sax();
+    bench_stream();
+    bench_ndjson();
+    return 0;
+}
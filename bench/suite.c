@@ -0,0 +1,425 @@
+// 标准语料上的基准测试，每项结果输出为一行 JSON，便于跨版本记录和比较
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "../photjson.h"
+
+#define SUITE_ROUNDS 5
+#define SUITE_MIN_SECONDS 0.2
+
+// 设为全局分配器，统计分配次数和存活的字节数，只在单线程下使用
+// 库交还的大小可能为 0（调用者释放序列化的结果时），所以每块前面仍放一个头记下大小
+typedef union {
+    size_t size;
+    max_align_t align;
+} alloc_header;
+
+static size_t alloc_count, live_bytes, peak_bytes;
+
+static void *bench_malloc(void *ctx, size_t size)
+{
+    (void)ctx;
+    alloc_header *h = (alloc_header *)malloc(sizeof(alloc_header) + size);
+    if (h == NULL) return NULL;
+    h->size = size;
+    alloc_count++;
+    live_bytes += size;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    return h + 1;
+}
+
+static void bench_free(void *ctx, void *ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    if (ptr == NULL) return;
+    alloc_header *h = (alloc_header *)ptr - 1;
+    live_bytes -= h->size;
+    free(h);
+}
+
+static void *bench_realloc(void *ctx, void *ptr, size_t old_size, size_t size)
+{
+    (void)ctx;
+    (void)old_size;
+    alloc_header *h = (alloc_header *)ptr - 1;
+    size_t old = h->size;
+    h = (alloc_header *)realloc(h, sizeof(alloc_header) + size);
+    if (h == NULL) return NULL;
+    h->size = size;
+    alloc_count++;
+    live_bytes = live_bytes - old + size;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    return h + 1;
+}
+
+// 使用进程的 CPU 时间，减少机器上其他负载的干扰
+static double now(void) { return (double)clock() / CLOCKS_PER_SEC; }
+
+// 在 Linux 上清零进程的内存峰值，之后读到的就是这一项测试的峰值；其它系统上为整个进程的峰值
+static void rss_reset(void)
+{
+#ifdef __linux__
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp != NULL) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+// 内存峰值，单位 KB，无法获取时返回 -1
+static long rss_peak_kb(void)
+{
+#ifdef __linux__
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp != NULL) {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(fp);
+        if (kb >= 0) return kb;
+    }
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+// 固定种子的线性同余发生器，每次运行生成相同的语料
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+// 可增长的输出缓冲区
+typedef struct {
+    char *buf;
+    size_t len, cap;
+} sbuf;
+
+static void sb_printf(sbuf *b, const char *format, ...)
+{
+    va_list args;
+    for (;;) {
+        va_start(args, format);
+        int n = vsnprintf(b->buf + b->len, b->cap - b->len, format, args);
+        va_end(args);
+        if ((size_t)n < b->cap - b->len) {
+            b->len += (size_t)n;
+            return;
+        }
+        b->cap = b->cap * 2 + (size_t)n + 1;
+        b->buf = (char *)realloc(b->buf, b->cap);
+    }
+}
+
+static sbuf sb_new(void)
+{
+    sbuf b = {(char *)malloc(4096), 0, 4096};
+    b.buf[0] = '\0';
+    return b;
+}
+
+// 数值数组：整数、定点小数与完整精度的浮点数交替出现
+static char *gen_numbers(void)
+{
+    sbuf b = sb_new();
+    sb_printf(&b, "[");
+    for (size_t i = 0; i < 600000; i++) {
+        uint32_t r = rng();
+        const char *sep = i > 0 ? "," : "";
+        switch (i % 3) {
+            case 0:
+                sb_printf(&b, "%s%ld", sep, (long)r - (1L << 30));
+                break;
+            case 1:
+                sb_printf(&b, "%s%.3f", sep, r / 1000.0);
+                break;
+            default:
+                sb_printf(&b, "%s%.17g", sep, (double)r / (rng() | 1) * 1e-5);
+        }
+    }
+    sb_printf(&b, "]");
+    return b.buf;
+}
+
+// 日志：字符串为主的记录，消息里带引号、换行等需要转义的字符
+static char *gen_logs(void)
+{
+    static const char *levels[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    static const char *words[] = {"request", "served", "cache", "miss", "upstream", "timeout", "user",
+                                  "login",   "from",   "retry", "after", "\\\"quoted\\\"", "\\n", "\\t"};
+    sbuf b = sb_new();
+    sb_printf(&b, "[");
+    for (size_t i = 0; i < 60000; i++) {
+        sb_printf(&b, "%s{\"timestamp\":\"2024-05-%02uT%02u:%02u:%02u.%03uZ\",\"level\":\"%s\",\"service\":\"api-gateway-%u\","
+                  "\"trace_id\":\"%08x%08x\",\"message\":\"",
+                  i > 0 ? "," : "", rng() % 28 + 1, rng() % 24, rng() % 60, rng() % 60, rng() % 1000, levels[rng() % 4],
+                  rng() % 16, rng(), rng());
+        for (uint32_t w = 0, n = rng() % 24 + 8; w < n; w++) {
+            sb_printf(&b, "%s%s", w > 0 ? " " : "", words[rng() % 14]);
+        }
+        sb_printf(&b, "\",\"path\":\"/v1/items/%u\",\"status\":%u}", rng() % 100000, 200 + rng() % 4 * 100);
+    }
+    sb_printf(&b, "]");
+    return b.buf;
+}
+
+// 嵌套配置：每层有几个标量设置和若干个子节
+static void gen_config_node(sbuf *b, int depth)
+{
+    sb_printf(b, "{\"name\":\"section_%u\",\"enabled\":%s,\"weight\":%.2f,\"limits\":[%u,%u,%u]", rng() % 1000,
+              rng() % 2 ? "true" : "false", rng() / 4e9, rng() % 100, rng() % 1000, rng() % 10000);
+    if (depth > 0) {
+        sb_printf(b, ",\"children\":{");
+        for (int i = 0; i < 3; i++) {
+            sb_printf(b, "%s\"child_%d\":", i > 0 ? "," : "", i);
+            gen_config_node(b, depth - 1);
+        }
+        sb_printf(b, "}");
+    }
+    sb_printf(b, "}");
+}
+
+static char *gen_config(void)
+{
+    sbuf b = sb_new();
+    gen_config_node(&b, 10);
+    return b.buf;
+}
+
+// 宽对象：每个对象有上千个互不相同的键
+static char *gen_wide(void)
+{
+    sbuf b = sb_new();
+    sb_printf(&b, "[");
+    for (size_t i = 0; i < 100; i++) {
+        sb_printf(&b, "%s{", i > 0 ? "," : "");
+        for (size_t j = 0; j < 1000; j++) {
+            sb_printf(&b, "%s\"field_%04zu\":%u", j > 0 ? "," : "", (j * 7919 + i) % 1000, rng() % 100000);
+        }
+        sb_printf(&b, "}");
+    }
+    sb_printf(&b, "]");
+    return b.buf;
+}
+
+// 与 test.in.json 形状相同、字符串为中文的记录
+static char *gen_cjk(void)
+{
+    static const char *chars[] = {"丁", "真", "珍", "珠", "四", "川", "甘", "孜", "理",
+                                  "塘", "格", "聂", "镇", "然", "日", "卡", "村"};
+    sbuf b = sb_new();
+    sb_printf(&b, "[");
+    for (size_t i = 0; i < 40000; i++) {
+        char text[4][64];
+        for (int t = 0; t < 4; t++) {
+            char *p = text[t];
+            for (uint32_t n = rng() % 8 + 2; n > 0; n--) {
+                p += sprintf(p, "%s", chars[rng() % 17]);
+            }
+        }
+        sb_printf(&b,
+                  "%s{\"name\":\"%s\",\"age\":%u,\"isAlive\":%s,\"isMarried\":false,\"hobbies\":[\"horse riding\",\"singing\"],"
+                  "\"address\":{\"city\":\"%s\",\"具体住址\":{\"county\":\"%s\",\"street\":\"%s\",\"houseNumber\":null}}}",
+                  i > 0 ? "," : "", text[0], rng() % 80 + 18, rng() % 2 ? "true" : "false", text[1], text[2], text[3]);
+    }
+    sb_printf(&b, "]");
+    return b.buf;
+}
+
+// 树中值的个数，容器本身也算一个
+static size_t count_values(const phot_elem *e)
+{
+    size_t n = 1, i;
+    switch (phot_get_type(e)) {
+        case PHOT_ARR:
+            for (i = 0; i < phot_get_arr_len(e); i++) {
+                n += count_values(phot_get_arr_elem(e, i));
+            }
+            break;
+        case PHOT_OBJ:
+            for (i = 0; i < phot_get_obj_len(e); i++) {
+                n += count_values(phot_get_obj_value(e, i));
+            }
+            break;
+        default:
+            break;
+    }
+    return n;
+}
+
+typedef enum { OP_PARSE, OP_STRINGIFY, OP_COPY, OP_EQUAL, OP_FREE } bench_op;
+
+static const char *op_names[] = {"phot_parse", "phot_stringify", "phot_copy", "phot_is_equal", "phot_free"};
+
+static void parse_or_die(phot_elem *e, const char *json)
+{
+    if (phot_parse(e, json) != PHOT_PARSE_OK) {
+        fprintf(stderr, "parse failed\n");
+        exit(1);
+    }
+}
+
+// 执行一次 op，返回计时部分的秒数；准备和清理不计时
+static double run_op(bench_op op, const char *json, const phot_elem *tree)
+{
+    phot_elem e;
+    phot_init(&e);
+    double start, elapsed = 0.0;
+    switch (op) {
+        case OP_PARSE:
+            start = now();
+            parse_or_die(&e, json);
+            elapsed = now() - start;
+            break;
+        case OP_STRINGIFY: {
+            start = now();
+            char *out = phot_stringify(tree, NULL);
+            elapsed = now() - start;
+            bench_free(NULL, out, 0);
+            break;
+        }
+        case OP_COPY:
+            start = now();
+            phot_copy(&e, tree);
+            elapsed = now() - start;
+            break;
+        case OP_EQUAL:
+            phot_copy(&e, tree);
+            start = now();
+            if (!phot_is_equal(&e, tree)) {
+                fprintf(stderr, "copy not equal\n");
+                exit(1);
+            }
+            elapsed = now() - start;
+            break;
+        case OP_FREE:
+            parse_or_die(&e, json);
+            start = now();
+            phot_free(&e);
+            elapsed = now() - start;
+            break;
+    }
+    phot_free(&e);
+    return elapsed;
+}
+
+// 分配次数和堆峰值只统计 op 本身，phot_is_equal 和 phot_free 的准备工作除外
+static void measure_allocs(bench_op op, const char *json, const phot_elem *tree, size_t *allocs, size_t *peak)
+{
+    phot_elem e;
+    phot_init(&e);
+    if (op == OP_EQUAL) {
+        phot_copy(&e, tree);
+    } else if (op == OP_FREE) {
+        parse_or_die(&e, json);
+    }
+    size_t count = alloc_count, base = live_bytes;
+    peak_bytes = live_bytes;
+    switch (op) {
+        case OP_PARSE:
+            parse_or_die(&e, json);
+            break;
+        case OP_STRINGIFY:
+            bench_free(NULL, phot_stringify(tree, NULL), 0);
+            break;
+        case OP_COPY:
+            phot_copy(&e, tree);
+            break;
+        case OP_EQUAL:
+            phot_is_equal(&e, tree);
+            break;
+        case OP_FREE:
+            phot_free(&e);
+            break;
+    }
+    *allocs = alloc_count - count;
+    *peak = peak_bytes - base;
+    phot_free(&e);
+}
+
+static void bench_corpus(const char *name, char *json)
+{
+    size_t len = strlen(json);
+    phot_elem tree;
+    phot_init(&tree);
+    parse_or_die(&tree, json);
+    size_t values = count_values(&tree);
+    for (int op = OP_PARSE; op <= OP_FREE; op++) {
+        size_t allocs, peak;
+        measure_allocs((bench_op)op, json, &tree, &allocs, &peak);
+        rss_reset();
+        double best = 1e30;
+        for (int round = 0; round < SUITE_ROUNDS; round++) {
+            size_t iters = 0;
+            double total = 0.0, start = now();
+            do {
+                total += run_op((bench_op)op, json, &tree);
+                iters++;
+            } while (now() - start < SUITE_MIN_SECONDS);
+            if (total / iters < best) {
+                best = total / iters;
+            }
+        }
+        printf("{\"corpus\":\"%s\",\"op\":\"%s\",\"bytes\":%zu,\"values\":%zu,\"mb_per_s\":%.1f,\"ns_per_value\":%.2f,"
+               "\"allocs_per_doc\":%zu,\"peak_heap_kb\":%.1f,\"peak_rss_kb\":%ld}\n",
+               name, op_names[op], len, values, len / best / 1e6, best * 1e9 / values, allocs, peak / 1024.0,
+               rss_peak_kb());
+        fflush(stdout);
+    }
+    phot_free(&tree);
+    free(json);
+}
+
+int main(void)
+{
+    phot_allocator counting = {bench_malloc, bench_realloc, bench_free, NULL};
+    phot_set_allocator(&counting);
+    static const struct {
+        const char *name;
+        char *(*gen)(void);
+    } corpora[] = {
+        {"numbers", gen_numbers}, {"logs", gen_logs}, {"config", gen_config}, {"wide", gen_wide}, {"cjk", gen_cjk},
+    };
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+        rng_state = 42;
+        bench_corpus(corpora[i].name, corpora[i].gen());
+    }
+    return 0;
+}
@@ -1,6 +1,11 @@
+// 文件映射需要 POSIX 接口，而 -std=c11 默认不暴露它们
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <assert.h>
-#include <errno.h>
-#include <math.h>
+#include <float.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -9,6 +14,67 @@
 
 #include "photjson.h"
 
+#ifndef PHOT_USE_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define PHOT_USE_MMAP 1
+#else
+#define PHOT_USE_MMAP 0
+#endif
+#endif
+
+#if PHOT_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef PHOT_USE_THREADS
+#if defined(__unix__) || defined(__APPLE__)
+#define PHOT_USE_THREADS 1
+#else
+#define PHOT_USE_THREADS 0
+#endif
+#endif
+
+#if PHOT_USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// 流式写出到文件描述符需要 POSIX 的 write
+#ifndef PHOT_USE_FD
+#if defined(__unix__) || defined(__APPLE__)
+#define PHOT_USE_FD 1
+#else
+#define PHOT_USE_FD 0
+#endif
+#endif
+
+#if PHOT_USE_FD
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+// 解析统计，默认不编译，见 phot_get_parse_stats
+#ifndef PHOT_USE_STATS
+#define PHOT_USE_STATS 0
+#endif
+
+#if PHOT_USE_STATS
+#include <time.h>
+#endif
+
+// 两阶段的结构索引后端目前比逐字节识别结构的解析慢，默认不编译，见 phot_set_backend
+#ifndef PHOT_USE_INDEX_BACKEND
+#define PHOT_USE_INDEX_BACKEND 0
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PHOT_X86 1
+#include <immintrin.h>
+#else
+#define PHOT_X86 0
+#endif
+
 #ifndef PHOT_PARSE_STACK_INIT_SIZE
 #define PHOT_PARSE_STACK_INIT_SIZE 256
 #endif
@@ -17,40 +83,314 @@
 #define PHOT_PARSE_STRINGIFY_INIT_SIZE 256
 #endif
 
-// 留着优化用
-#define LIKELY(x) __builtin_expect(!!(x), 1)    // x 很可能为真
-#define UNLIKELY(x) __builtin_expect(!!(x), 0)  // x 很可能为假
+#ifndef PHOT_DOC_CHUNK_INIT_SIZE
+#define PHOT_DOC_CHUNK_INIT_SIZE 4096
+#endif
+
+// phot_intern_new 的 max_keys 为 0 时驻留表最多容纳的键数
+#ifndef PHOT_INTERN_MAX_KEYS
+#define PHOT_INTERN_MAX_KEYS 4096
+#endif
+
+#ifndef PHOT_READ_CHUNK_SIZE
+#define PHOT_READ_CHUNK_SIZE 65536
+#endif
+
+#ifndef PHOT_INDEX_WINDOW
+#define PHOT_INDEX_WINDOW 4096  // 结构索引每次分类的字节数，须为 64 的倍数且不超过 65536
+#endif
+
+// 流式序列化的缓冲区大小，写满后交给输出回调
+#ifndef PHOT_WRITER_BUF_SIZE
+#define PHOT_WRITER_BUF_SIZE (1 << 16)
+#endif
+
+// 美化输出预先生成的缩进字符数，更深的缩进分几段拷贝
+#ifndef PHOT_INDENT_RUN
+#define PHOT_INDENT_RUN 128
+#endif
+
+#ifndef PHOT_NDJSON_BATCH_SIZE
+#define PHOT_NDJSON_BATCH_SIZE (1 << 20)  // NDJSON 每个线程一次取走的字节数，在其后的第一个换行处截断
+#endif
+
+#ifndef PHOT_OBJ_INDEX_THRESHOLD
+#define PHOT_OBJ_INDEX_THRESHOLD 16
+#endif
+
+// 默认的最大嵌套深度，见 phot_set_max_depth
+#ifndef PHOT_PARSE_MAX_DEPTH
+#define PHOT_PARSE_MAX_DEPTH 1024
+#endif
+
+// 非递归遍历的显式栈先放在 C 栈上，嵌套更深时才搬到堆上
+#ifndef PHOT_WALK_LOCAL_DEPTH
+#define PHOT_WALK_LOCAL_DEPTH 32
+#endif
+
+// 分支预测和内联提示，热路径上的错误处理都标为 UNLIKELY
+#define LIKELY(x) __builtin_expect(!!(x), 1)                 // x 很可能为真
+#define UNLIKELY(x) __builtin_expect(!!(x), 0)               // x 很可能为假
+#define NOINLINE __attribute__((noinline))                   // 冷路径不要内联进热点函数
+#define ALWAYS_INLINE inline __attribute__((always_inline))  // 按常量参数展开成多份
+
+// 按块扫描时会读到输入结尾之后同一对齐块内的字节，它们不会跨页，但 ASan 和 TSan 会误报
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address, no_sanitize_thread))
+
+typedef struct phot_index phot_index;
+
+#if PHOT_USE_STATS
+// 正在进行的一次解析的统计，depth 为当前的嵌套深度
+typedef struct {
+    phot_parse_stats s;
+    size_t depth;
+} phot_stats_state;
+
+// 当前线程正在进行的解析，没有时为空；以及最近一次解析的结果
+static _Thread_local phot_stats_state *phot_stats_cur;
+static _Thread_local phot_parse_stats phot_stats_last;
+
+// 只在有解析正在进行时累加
+#define PHOT_STAT(stmt)               \
+    do {                              \
+        if (phot_stats_cur != NULL) { \
+            phot_stats_cur->s.stmt;   \
+        }                             \
+    } while (0)
+
+static inline void phot_stats_enter(void)
+{
+    phot_stats_state *st = phot_stats_cur;
+    if (st != NULL && ++st->depth > st->s.max_depth) {
+        st->s.max_depth = st->depth;
+    }
+}
+
+static inline void phot_stats_leave(void)
+{
+    if (phot_stats_cur != NULL) {
+        phot_stats_cur->depth--;
+    }
+}
+
+static double phot_stats_now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define PHOT_STAT_ENTER() phot_stats_enter()
+#define PHOT_STAT_LEAVE() phot_stats_leave()
+#else
+#define PHOT_STAT(stmt) ((void)0)
+#define PHOT_STAT_ENTER() ((void)0)
+#define PHOT_STAT_LEAVE() ((void)0)
+#endif
+
+static void *phot_default_alloc(void *ctx, size_t size)
+{
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *phot_default_realloc(void *ctx, void *ptr, size_t old_size, size_t size)
+{
+    (void)ctx;
+    (void)old_size;
+    return realloc(ptr, size);
+}
+
+static void phot_default_free(void *ctx, void *ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+// 堆上的元素和没有指定分配器的文档使用的分配器
+static phot_allocator phot_allocator_global = {phot_default_alloc, phot_default_realloc, phot_default_free, NULL};
+
+// 库内的分配都经过这几个函数，a 为空时使用全局的分配器；使用默认的分配器时直接调用，省去间接调用
+// 分配器不会收到空指针：从空指针 realloc 改为 alloc，释放空指针什么也不做
+static inline void *phot_mem_alloc_with(const phot_allocator *a, size_t size)
+{
+    PHOT_STAT(allocs++);
+    a = a != NULL ? a : &phot_allocator_global;
+    if (LIKELY(a->alloc == phot_default_alloc)) return malloc(size);
+    return a->alloc(a->ctx, size);
+}
+
+static inline void *phot_mem_realloc_with(const phot_allocator *a, void *ptr, size_t old_size, size_t size)
+{
+    if (ptr == NULL) return phot_mem_alloc_with(a, size);
+    PHOT_STAT(allocs++);
+    a = a != NULL ? a : &phot_allocator_global;
+    if (LIKELY(a->realloc == phot_default_realloc)) return realloc(ptr, size);
+    return a->realloc(a->ctx, ptr, old_size, size);
+}
+
+static inline void phot_mem_free_with(const phot_allocator *a, void *ptr, size_t size)
+{
+    if (ptr == NULL) return;
+    a = a != NULL ? a : &phot_allocator_global;
+    if (LIKELY(a->free == phot_default_free)) {
+        free(ptr);
+        return;
+    }
+    a->free(a->ctx, ptr, size);
+}
+
+static inline void *phot_mem_alloc(size_t size) { return phot_mem_alloc_with(NULL, size); }
+
+static inline void *phot_mem_realloc(void *ptr, size_t old_size, size_t size)
+{
+    return phot_mem_realloc_with(NULL, ptr, old_size, size);
+}
+
+static inline void phot_mem_free(void *ptr, size_t size) { phot_mem_free_with(NULL, ptr, size); }
+
+// 美化输出的换行和缩进：换行符之后紧跟一串缩进字符，换行时连同缩进整段拷贝
+typedef struct {
+    char run[2 + PHOT_INDENT_RUN];
+    size_t newline;  // 换行符的长度
+    size_t indent;   // 每层缩进的字符数
+    bool space;      // ':' 之后加空格
+} phot_pretty;
+
+// 一次解析中驻留表的查询计数，解析结束时一并累加到表上，避免各线程争用同一缓存行
+typedef struct {
+    size_t lookups, hits, saved;
+} phot_intern_tally;
 
 typedef struct {
     const char *json;
+    const char *end;               // 输入的结尾，不要求此处是 '\0'
+    phot_index *index;             // 非空时由结构索引给出下一个 token 的位置，只在 PHOT_USE_INDEX_BACKEND 下使用
     char *stack;
     size_t size, top;
+    phot_doc *doc;                 // 非空时解析结果分配在文档的 arena 中
+    bool insitu;                   // 原地解析，字符串直接解码到输入缓冲区中
+    phot_intern *keys;             // 非空时长键从驻留表中共享
+    phot_intern_tally tally;       // keys 非空时有效
+    const phot_handler *handler;  // 接收解析事件的处理器
+    void *ud;                      // 传给处理器或输出回调的用户数据
+    phot_write_cb write;           // 非空时流式序列化，栈中的输出积满一个缓冲区就交给它
+    bool write_failed;             // 输出回调失败过，之后的输出都丢弃
+    const phot_pretty *pretty;     // 非空时美化输出
 } phot_context;
 
+struct phot_chunk {
+    phot_chunk *next;
+    size_t size;          // data 的字节数
+    max_align_t data[];  // 按最大对齐要求排布
+};
+
 
 static inline void expect(phot_context *c, char ch)
 {
-    assert(*c->json == ch);
+    assert(c->json != c->end && *c->json == ch);
     c->json++;
 }
 
+// 越过输入结尾时视为读到 '\0'，于是之后的判断都与 NUL 结尾的输入一致
+static inline char phot_at(const char *p, const char *end) { return p != end ? *p : '\0'; }
+
+static inline char phot_peek(const phot_context *c) { return phot_at(c->json, c->end); }
+
 // digit 指单个的数字，number 指一个抽象的数
 static inline bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
 
 static inline bool is_digit_1to9(char ch) { return ch >= '1' && ch <= '9'; }
 
+// 可能出现在数字中的字符
+static inline bool is_num_char(char ch)
+{
+    return is_digit(ch) || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+// 元素中的长度和容量只有 32 位，超出的字符串和容器在解析时报 PHOT_PARSE_TOO_LONG，修改接口拒绝执行
+static inline bool phot_len_fits(size_t n) { return n <= UINT32_MAX; }
+
+// 数组和对象满了以后容量翻倍，不超过 32 位能表示的上限
+static inline size_t phot_grow_cap(size_t len)
+{
+    return len == 0 ? 1 : len > UINT32_MAX / 2 ? UINT32_MAX : len * 2;
+}
+
+// 调用方已经用 phot_len_fits 检查过
+static inline uint32_t phot_len32(size_t n)
+{
+    assert(n <= UINT32_MAX);
+    return (uint32_t)n;
+}
+
+// 短字符串连同结尾的 '\0' 从元素的开头存放到 sso_len 之前
+#define PHOT_SSO_MAX (offsetof(phot_elem, sso_len) - 1)
+
+static inline const char *phot_str_ptr(const phot_elem *e)
+{
+    return (e->flags & PHOT_FLAG_INLINE) ? (const char *)e : e->str;
+}
+
+static inline size_t phot_str_len(const phot_elem *e) { return (e->flags & PHOT_FLAG_INLINE) ? e->sso_len : e->len; }
+
+// 把不超过 PHOT_SSO_MAX 的字符串写进元素内
+static inline void phot_str_inline(phot_elem *e, const char *str, size_t len)
+{
+    assert(len <= PHOT_SSO_MAX);
+    memcpy((char *)e, str, len);
+    ((char *)e)[len] = '\0';
+    e->sso_len = (unsigned char)len;
+    e->type = PHOT_STR;
+    e->flags = PHOT_FLAG_INLINE;
+}
+
+// 借用别处的字符串，phot_free 时不释放
+static inline void phot_str_borrow(phot_elem *e, const char *str, size_t len)
+{
+    e->str = (char *)str;
+    e->len = phot_len32(len);
+    e->type = PHOT_STR;
+    e->flags = PHOT_FLAG_BORROWED;
+}
+
+// 元素持有字符串的副本，放不下时才分配在堆上
+static void phot_str_init(phot_elem *e, const char *str, size_t len)
+{
+    if (len <= PHOT_SSO_MAX) {
+        phot_str_inline(e, str, len);
+        return;
+    }
+    e->str = (char *)phot_mem_alloc(len + 1);
+    assert(e->str != NULL);
+    memcpy(e->str, str, len);
+    e->str[len] = '\0';
+    e->len = phot_len32(len);
+    e->type = PHOT_STR;
+    e->flags = 0;
+}
+
+// 文档模式下解析栈属于文档，用文档的分配器
+static inline const phot_allocator *phot_context_allocator(const phot_context *c)
+{
+    return c->doc != NULL ? c->doc->alloc : NULL;
+}
+
 // 虚假的 push，只分配了空间，还需手动把东西压进去
 static void *phot_context_push(phot_context *c, size_t size)
 {
     assert(size > 0);
     if (c->top + size >= c->size) {
+        size_t old_size = c->size;
         if (c->size == 0) {
             c->size = PHOT_PARSE_STACK_INIT_SIZE;
         }
         while (c->top + size > c->size) {
             c->size += c->size >> 1;  // 将 c->size 增加到原来的 1.5 倍
         }
-        c->stack = (char *)realloc(c->stack, c->size);
+        PHOT_STAT(stack_reallocs++);
+        c->stack = (char *)phot_mem_realloc_with(phot_context_allocator(c), c->stack, old_size, c->size);
         assert(c->stack != NULL);
     }
     void *ret = c->stack + c->top;
@@ -65,25 +405,135 @@ static inline void *phot_context_pop(phot_context *c, size_t size)
     return c->stack + c->top;
 }
 
-static inline void phot_push_ch(phot_context *c, char ch) { *(char *)phot_context_push(c, sizeof(char)) = ch; }
+// 显式栈从调用者栈上的 local 开始，放满后搬到堆上，之后按 2 倍增长
+static void *phot_grow_local(const phot_allocator *a, void *buf, const void *local, size_t *cap, size_t size)
+{
+    size_t old_cap = *cap;
+    *cap *= 2;
+    if (buf == local) {
+        void *ret = phot_mem_alloc_with(a, *cap * size);
+        assert(ret != NULL);
+        memcpy(ret, buf, old_cap * size);
+        return ret;
+    }
+    buf = phot_mem_realloc_with(a, buf, old_cap * size, *cap * size);
+    assert(buf != NULL);
+    return buf;
+}
 
-static inline void phot_push_str(phot_context *c, const char *str, size_t len)
+// 非递归解析时外层未闭合的数组和对象，每项为 (已解析的个数 << 1) | 是否为对象，与增量解析的 nest 栈相同
+typedef struct {
+    size_t *level;
+    size_t cap;
+    size_t local[PHOT_WALK_LOCAL_DEPTH];
+} phot_levels;
+
+// 非递归遍历元素树时的一层：正在遍历的容器和下一个子元素的下标
+typedef struct {
+    const phot_elem *src;
+    phot_elem *dst;  // phot_free 和 phot_copy 写入的容器，phot_is_equal 的另一侧
+    size_t i;
+} phot_frame;
+
+typedef struct {
+    phot_frame *frame;
+    size_t depth, cap;
+    phot_frame local[PHOT_WALK_LOCAL_DEPTH];
+} phot_walk;
+
+// 展开过的非空容器才有子元素，惰性元素须先展开
+static inline bool phot_has_children(const phot_elem *e)
 {
-    memcpy(phot_context_push(c, len), str, len);
+    return (e->type == PHOT_ARR || e->type == PHOT_OBJ) && e->len > 0 && !(e->flags & PHOT_FLAG_LAZY);
 }
 
-static void phot_parse_whitespace(phot_context *c)
+static inline void phot_walk_init(phot_walk *w)
 {
-    const char *p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
-        p++;
+    w->frame = w->local;
+    w->depth = 0;
+    w->cap = PHOT_WALK_LOCAL_DEPTH;
+}
+
+static inline void phot_walk_push(phot_walk *w, const phot_elem *src, phot_elem *dst)
+{
+    if (UNLIKELY(w->depth == w->cap)) {
+        w->frame = (phot_frame *)phot_grow_local(NULL, w->frame, w->local, &w->cap, sizeof(phot_frame));
     }
-    c->json = p;
+    phot_frame *f = &w->frame[w->depth++];
+    f->src = src;
+    f->dst = dst;
+    f->i = 0;
+}
+
+static inline void phot_walk_free(phot_walk *w)
+{
+    if (w->frame != w->local) {
+        phot_mem_free(w->frame, w->cap * sizeof(phot_frame));
+    }
+}
+
+// 从 cur 往后找一个放得下 size 字节的块，找不到就在链表尾部追加新块
+static void phot_doc_next_chunk(phot_doc *doc, size_t size)
+{
+    phot_chunk *last = doc->cur;
+    phot_chunk *chunk = doc->cur != NULL ? doc->cur->next : doc->head;
+    for (; chunk != NULL; last = chunk, chunk = chunk->next) {
+        if (chunk->size >= size) {
+            doc->cur = chunk;
+            doc->used = 0;
+            return;
+        }
+    }
+    size_t chunk_size = last != NULL ? last->size * 2 : PHOT_DOC_CHUNK_INIT_SIZE;
+    while (chunk_size < size) {
+        chunk_size *= 2;
+    }
+    chunk = (phot_chunk *)phot_mem_alloc_with(doc->alloc, sizeof(phot_chunk) + chunk_size);
+    assert(chunk != NULL);
+    chunk->next = NULL;
+    chunk->size = chunk_size;
+    if (last != NULL) {
+        last->next = chunk;
+    } else {
+        doc->head = chunk;
+    }
+    doc->cur = chunk;
+    doc->used = 0;
+}
+
+// bump 分配，align 必须是 2 的幂
+static void *phot_doc_alloc(phot_doc *doc, size_t size, size_t align)
+{
+    size_t offset = (doc->used + align - 1) & ~(align - 1);
+    if (doc->cur == NULL || offset + size > doc->cur->size) {
+        phot_doc_next_chunk(doc, size);
+        offset = 0;
+    }
+    doc->used = offset + size;
+    return (char *)doc->cur->data + offset;
+}
+
+// 为解析结果分配内存，文档模式下从 arena 分配，否则从堆上分配
+static inline void *phot_context_alloc(phot_context *c, size_t size, size_t align)
+{
+    if (c->doc != NULL) {
+        return phot_doc_alloc(c->doc, size, align);
+    }
+    void *ret = phot_mem_alloc(size);
+    assert(ret != NULL);
+    return ret;
+}
+
+static inline void phot_push_ch(phot_context *c, char ch) { *(char *)phot_context_push(c, sizeof(char)) = ch; }
+
+static inline void phot_push_str(phot_context *c, const char *str, size_t len)
+{
+    memcpy(phot_context_push(c, len), str, len);
 }
 
 static int phot_parse_null(phot_context *c, phot_elem *e)
 {
-    if (strncmp(c->json, "null", 4) != 0) return PHOT_PARSE_INVALID_VALUE;
+    if (c->end - c->json < 4 || memcmp(c->json, "null", 4) != 0) return PHOT_PARSE_INVALID_VALUE;
     c->json += 4;
     e->type = PHOT_NULL;
     return PHOT_PARSE_OK;
@@ -94,11 +544,11 @@ static int phot_parse_bool(phot_context *c, phot_elem *e)
     const char *p = c->json;
     bool value;
     if (*p == 't') {
-        if (strncmp(p, "true", 4) != 0) return PHOT_PARSE_INVALID_VALUE;
+        if (c->end - p < 4 || memcmp(p, "true", 4) != 0) return PHOT_PARSE_INVALID_VALUE;
         value = true;
         c->json += 4;
     } else if (*p == 'f') {
-        if (strncmp(p, "false", 5) != 0) return PHOT_PARSE_INVALID_VALUE;
+        if (c->end - p < 5 || memcmp(p, "false", 5) != 0) return PHOT_PARSE_INVALID_VALUE;
         value = false;
         c->json += 5;
     } else {
@@ -109,413 +559,3453 @@ static int phot_parse_bool(phot_context *c, phot_elem *e)
     return PHOT_PARSE_OK;
 }
 
-static int phot_parse_num(phot_context *c, phot_elem *e)
+// 数字解析：一趟扫描累积有效数字，再按 Clinger 快速路径、Eisel-Lemire 算法、大整数比较的顺序转换为 double
+// 全程不依赖 strtod，因此不受 locale 影响，也不会修改 errno
+
+#define NUM_MAX_DIGITS 19     // uint64_t 一定能容纳的十进制位数
+#define NUM_BIG_DIGITS 768    // 判定 double 舍入所需的有效数字上限，更多的数字只影响是否恰好在中点上
+#define NUM_MIN_POW10 (-342)  // 更小的 10 的幂乘以 19 位数字也会下溢为 0
+#define NUM_MAX_POW10 308     // 更大的 10 的幂乘以非零数字一定上溢
+
+// 5^q 的高 128 位（q 为负时为 2^k/5^-q 向上取整后的高 128 位），q 取 [-342, 308]，每两项为一组
+static const uint64_t phot_pow5_128[] = {
+    0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL, 0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL,
+    0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL, 0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL,
+    0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL, 0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL,
+    0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL, 0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL,
+    0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL, 0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL,
+    0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL, 0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL,
+    0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL, 0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL,
+    0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL, 0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL,
+    0x84A57695FE98746DULL, 0x014BB630F7604B57ULL, 0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL,
+    0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL, 0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL,
+    0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL, 0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL,
+    0xFD00B897478238D0ULL, 0x8920B098955522B4ULL, 0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL,
+    0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL, 0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL,
+    0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL, 0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL,
+    0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL, 0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL,
+    0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL, 0xEBA09271E88D976BULL, 0xF7864A44C633682EULL,
+    0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL, 0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL,
+    0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL, 0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL,
+    0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL, 0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL,
+    0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL, 0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL,
+    0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL, 0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL,
+    0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL, 0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL,
+    0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL, 0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL,
+    0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL, 0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL,
+    0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL, 0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL,
+    0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL, 0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL,
+    0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL, 0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL,
+    0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL, 0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL,
+    0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL, 0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL,
+    0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL, 0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL,
+    0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL, 0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL,
+    0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL, 0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL,
+    0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL, 0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL,
+    0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL, 0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL,
+    0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL, 0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL,
+    0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL, 0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL,
+    0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL, 0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL,
+    0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL, 0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL,
+    0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL, 0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL,
+    0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL, 0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL,
+    0xC987434744AC874EULL, 0xA327FFB266B56220ULL, 0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL,
+    0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL, 0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL,
+    0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL, 0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL,
+    0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL, 0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL,
+    0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL, 0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL,
+    0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL, 0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL,
+    0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL, 0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL,
+    0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL, 0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL,
+    0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL, 0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL,
+    0xAECC49914078536DULL, 0x58FAE9F773886E18ULL, 0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL,
+    0x888F99797A5E012DULL, 0x6D8406C952429603ULL, 0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL,
+    0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL, 0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL,
+    0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL, 0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL,
+    0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL, 0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL,
+    0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL, 0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL,
+    0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL, 0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL,
+    0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL, 0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL,
+    0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL, 0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL,
+    0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL, 0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL,
+    0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL, 0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL,
+    0xB913179899F68584ULL, 0x28E2557B59846E3FULL, 0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL,
+    0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL, 0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL,
+    0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL, 0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL,
+    0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL, 0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL,
+    0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL, 0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL,
+    0xD77485CB25823AC7ULL, 0x7D633293366B828BULL, 0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL,
+    0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL, 0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL,
+    0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL, 0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL,
+    0xCD795BE870516656ULL, 0x67902E276C921F8BULL, 0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL,
+    0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL, 0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL,
+    0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL, 0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL,
+    0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL, 0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL,
+    0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL, 0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL,
+    0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL, 0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL,
+    0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL, 0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL,
+    0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL, 0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL,
+    0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL, 0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL,
+    0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL, 0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL,
+    0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL, 0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL,
+    0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL, 0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL,
+    0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL, 0xD47487CC8470652BULL, 0x7647C3200069671FULL,
+    0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL, 0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL,
+    0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL, 0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL,
+    0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL, 0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL,
+    0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL, 0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL,
+    0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL, 0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL,
+    0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL, 0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL,
+    0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL, 0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL,
+    0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL, 0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL,
+    0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL, 0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL,
+    0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL, 0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL,
+    0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL, 0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL,
+    0x8C974F7383725573ULL, 0x1E414218C73A13FBULL, 0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL,
+    0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL, 0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL,
+    0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL, 0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL,
+    0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL, 0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL,
+    0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL, 0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL,
+    0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL, 0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL,
+    0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL, 0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL,
+    0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL, 0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL,
+    0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL, 0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL,
+    0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL, 0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL,
+    0xBE89523386091465ULL, 0xF6BBB397F1135823ULL, 0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL,
+    0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL, 0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL,
+    0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL, 0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL, 0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL,
+    0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL, 0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL,
+    0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL, 0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL,
+    0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL, 0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL,
+    0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL, 0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL,
+    0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL, 0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL,
+    0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL, 0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL,
+    0x811CCC668829B887ULL, 0x0806357D5A3F525FULL, 0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL,
+    0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL, 0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL,
+    0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL, 0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL,
+    0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL, 0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL,
+    0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL, 0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL,
+    0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL, 0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL,
+    0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL, 0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL,
+    0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL, 0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL,
+    0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL, 0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL,
+    0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL, 0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL,
+    0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL, 0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL,
+    0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL, 0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL,
+    0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL, 0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL,
+    0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL, 0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL,
+    0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL, 0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL,
+    0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL, 0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL,
+    0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL, 0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL,
+    0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL, 0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL,
+    0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL, 0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL,
+    0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL, 0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL,
+    0xED246723473E3813ULL, 0x290123E9AAB23B68ULL, 0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL,
+    0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL, 0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL,
+    0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL, 0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL,
+    0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL, 0x8D590723948A535FULL, 0x579C487E5A38AD0EULL,
+    0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL, 0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL,
+    0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL, 0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL,
+    0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL, 0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL,
+    0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL, 0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL,
+    0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL, 0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL,
+    0xCDB02555653131B6ULL, 0x3792F412CB06794DULL, 0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL,
+    0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL, 0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL,
+    0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL, 0x9CED737BB6C4183DULL, 0x55464DD69685606BULL,
+    0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL, 0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL,
+    0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL, 0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL,
+    0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL, 0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL,
+    0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL, 0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL,
+    0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL, 0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL,
+    0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL, 0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL,
+    0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL, 0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL,
+    0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL, 0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL,
+    0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL, 0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL,
+    0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL, 0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL,
+    0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL, 0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL,
+    0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL, 0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL,
+    0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL, 0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL,
+    0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL, 0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL,
+    0xC612062576589DDAULL, 0x95364AFE032A819EULL, 0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL,
+    0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL, 0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL,
+    0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL, 0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL,
+    0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL, 0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL,
+    0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL, 0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL,
+    0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL, 0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL,
+    0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL, 0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL,
+    0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL, 0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL,
+    0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL, 0x89705F4136B4A597ULL, 0x31680A88F8953031ULL,
+    0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL, 0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL,
+    0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL, 0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL,
+    0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL, 0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL,
+    0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL, 0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL, 0xA000000000000000ULL, 0x0000000000000000ULL,
+    0xC800000000000000ULL, 0x0000000000000000ULL, 0xFA00000000000000ULL, 0x0000000000000000ULL,
+    0x9C40000000000000ULL, 0x0000000000000000ULL, 0xC350000000000000ULL, 0x0000000000000000ULL,
+    0xF424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xBEBC200000000000ULL, 0x0000000000000000ULL, 0xEE6B280000000000ULL, 0x0000000000000000ULL,
+    0x9502F90000000000ULL, 0x0000000000000000ULL, 0xBA43B74000000000ULL, 0x0000000000000000ULL,
+    0xE8D4A51000000000ULL, 0x0000000000000000ULL, 0x9184E72A00000000ULL, 0x0000000000000000ULL,
+    0xB5E620F480000000ULL, 0x0000000000000000ULL, 0xE35FA931A0000000ULL, 0x0000000000000000ULL,
+    0x8E1BC9BF04000000ULL, 0x0000000000000000ULL, 0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL,
+    0xDE0B6B3A76400000ULL, 0x0000000000000000ULL, 0x8AC7230489E80000ULL, 0x0000000000000000ULL,
+    0xAD78EBC5AC620000ULL, 0x0000000000000000ULL, 0xD8D726B7177A8000ULL, 0x0000000000000000ULL,
+    0x878678326EAC9000ULL, 0x0000000000000000ULL, 0xA968163F0A57B400ULL, 0x0000000000000000ULL,
+    0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL, 0x84595161401484A0ULL, 0x0000000000000000ULL,
+    0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL, 0xCECB8F27F4200F3AULL, 0x0000000000000000ULL,
+    0x813F3978F8940984ULL, 0x4000000000000000ULL, 0xA18F07D736B90BE5ULL, 0x5000000000000000ULL,
+    0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL, 0xFC6F7C4045812296ULL, 0x4D00000000000000ULL,
+    0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL, 0xC5371912364CE305ULL, 0x6C28000000000000ULL,
+    0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL, 0x9A130B963A6C115CULL, 0x3C7F400000000000ULL,
+    0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL, 0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL,
+    0x96769950B50D88F4ULL, 0x1314448000000000ULL, 0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL,
+    0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL, 0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL,
+    0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL, 0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL,
+    0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL, 0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL,
+    0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL, 0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL,
+    0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL, 0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL,
+    0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL, 0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL,
+    0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL, 0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL,
+    0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL, 0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL,
+    0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL, 0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL,
+    0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL, 0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL,
+    0x9F4F2726179A2245ULL, 0x01D762422C946590ULL, 0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL,
+    0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL, 0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL,
+    0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL, 0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL,
+    0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL, 0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL,
+    0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL, 0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL,
+    0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL, 0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL,
+    0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL, 0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL,
+    0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL, 0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL,
+    0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL, 0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL,
+    0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL, 0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL,
+    0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL, 0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL,
+    0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL, 0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL,
+    0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL, 0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL,
+    0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL, 0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL,
+    0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL, 0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL,
+    0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL, 0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL,
+    0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL, 0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL,
+    0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL, 0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL,
+    0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL, 0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL,
+    0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL, 0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL,
+    0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL, 0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL,
+    0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL, 0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL,
+    0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL, 0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL,
+    0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL, 0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL,
+    0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL, 0x884134FE908658B2ULL, 0x3109058D147FDCDDULL,
+    0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL, 0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL,
+    0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL, 0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL,
+    0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL, 0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL,
+    0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL, 0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL,
+    0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL, 0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL,
+    0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL, 0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL,
+    0x9AE757596946075FULL, 0x3375788DE9B06958ULL, 0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL,
+    0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL, 0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL,
+    0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL, 0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL,
+    0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL, 0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL,
+    0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL, 0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL,
+    0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL, 0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL,
+    0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL, 0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL,
+    0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL, 0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL,
+    0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL, 0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL,
+    0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL, 0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL,
+    0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL, 0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL,
+    0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL, 0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL,
+    0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL, 0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL,
+    0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL, 0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL,
+    0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL, 0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL,
+    0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL, 0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL,
+    0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL, 0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL,
+    0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL, 0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL,
+    0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL, 0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL,
+    0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL, 0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL,
+    0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL, 0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL,
+    0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL, 0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL,
+    0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL, 0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL,
+    0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL, 0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL,
+    0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL, 0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL,
+    0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL, 0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL,
+    0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL, 0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL,
+    0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL, 0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL,
+    0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL, 0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL,
+    0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL, 0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL,
+    0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL, 0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL,
+    0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL, 0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL,
+    0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL, 0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL,
+    0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL, 0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL,
+    0x8FA475791A569D10ULL, 0xF96E017D694487BCULL, 0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL,
+    0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL, 0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL,
+    0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL, 0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL,
+    0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL, 0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL,
+    0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL, 0x85C7056562757456ULL, 0xF6872D5667844E49ULL,
+    0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL, 0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL,
+    0x82A45B450226B39CULL, 0xECC0024661173473ULL, 0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL,
+    0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL, 0xFF290242C83396CEULL, 0x7E67047175A15271ULL,
+    0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL, 0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL,
+    0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL, 0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL,
+    0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL, 0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL,
+    0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL, 0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL,
+    0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL, 0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL,
+    0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL, 0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL,
+    0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL, 0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL,
+    0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL, 0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL,
+    0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL, 0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL,
+    0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL, 0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL,
+    0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL, 0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL,
+    0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL, 0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL,
+    0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL, 0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL,
+    0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL, 0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL,
+    0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL, 0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL,
+    0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL, 0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL,
+    0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL, 0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL,
+    0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL, 0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL,
+    0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL, 0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL,
+    0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL, 0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL,
+    0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL, 0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL,
+    0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL, 0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL,
+    0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL, 0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL,
+    0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL, 0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL,
+    0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL, 0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL,
+    0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL, 0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL,
+    0x8533285C936B35DEULL, 0xD53A88958F87275FULL, 0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL,
+    0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL, 0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL,
+    0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL, 0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL,
+    0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL, 0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL,
+    0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL, 0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL,
+    0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL, 0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL,
+    0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL, 0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL,
+    0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL, 0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL,
+    0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL, 0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL,
+    0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL, 0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL,
+    0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL, 0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL,
+    0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL, 0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL,
+    0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL, 0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL,
+    0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL, 0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL,
+    0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL, 0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL,
+    0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL, 0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL,
+    0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL, 0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL,
+    0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL, 0xA0555E361951C366ULL, 0xD7E105BCC332621FULL,
+    0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL, 0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL,
+    0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL, 0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL,
+    0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL, 0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL,
+    0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL, 0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL,
+    0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL, 0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL,
+    0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL, 0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL,
+    0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL, 0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL,
+    0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL,
+};
+
+// 可以被 double 精确表示的 10 的幂
+static const double phot_pow10_exact[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// 返回 a * b 的低 64 位，高 64 位写入 hi
+static inline uint64_t phot_umul128(uint64_t a, uint64_t b, uint64_t *hi)
 {
-    const char *p = c->json;
-    if (*p == '-') {
-        p++;
+#ifdef __SIZEOF_INT128__
+    __extension__ unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    *hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+static inline double phot_bits_to_double(uint64_t bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+#define DOUBLE_INF_BITS 0x7FF0000000000000ULL
+
+// Eisel-Lemire 算法，返回 w * 10^q 舍入后的位表示（不含符号），w 非零且 q 在表的范围内
+// 对精确的 w 结果总是正确舍入的
+static uint64_t phot_eisel_lemire(uint64_t w, int64_t q)
+{
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+    const uint64_t *pow5 = &phot_pow5_128[(q - NUM_MIN_POW10) * 2];
+    uint64_t hi, lo = phot_umul128(w, pow5[0], &hi);
+    // 高位中用于舍入的 55 位之后全为 1 时，需要用低 64 位的乘积修正
+    if ((hi & 0x1FF) == 0x1FF) {
+        uint64_t hi2;
+        phot_umul128(w, pow5[1], &hi2);
+        lo += hi2;
+        if (hi2 > lo) {
+            hi++;
+        }
     }
-    if (*p == '0') {
-        p++;
-    } else {
-        if (!is_digit_1to9(*p)) return PHOT_PARSE_INVALID_VALUE;
-        for (p++; is_digit(*p); p++);
+    int upperbit = (int)(hi >> 63);
+    uint64_t mantissa = hi >> (upperbit + 9);
+    // (217706 * q) >> 16 即 floor(q * log2(10))
+    int32_t power2 = (int32_t)((((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + 1023);
+    if (power2 <= 0) {  // 次正规数
+        if (-power2 + 1 >= 64) return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        return mantissa;  // 进位到 2^52 时恰好得到最小的正规数
     }
-    if (*p == '.') {
-        p++;
-        if (!is_digit(*p)) return PHOT_PARSE_INVALID_VALUE;
-        for (p++; is_digit(*p); p++);
+    // 通常向上舍入，但恰好落在中点上时需要舍入到偶数
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << (upperbit + 9)) == hi) {
+        mantissa &= ~(uint64_t)1;
     }
-    if (*p == 'e' || *p == 'E') {
-        p++;
-        if (*p == '+' || *p == '-') {
-            p++;
-        }
-        if (!is_digit(*p)) return PHOT_PARSE_INVALID_VALUE;
-        for (p++; is_digit(*p); p++);
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t)2 << 52) {
+        mantissa = (uint64_t)1 << 52;
+        power2++;
     }
-    // 至此说明数字格式正确
-    errno = 0;
-    e->num = strtod(c->json, NULL);
-    if (errno == ERANGE && (e->num == HUGE_VAL || e->num == -HUGE_VAL)) return PHOT_PARSE_NUM_TOO_BIG;
-    c->json = p;
-    e->type = PHOT_NUM;
-    return PHOT_PARSE_OK;
+    if (power2 >= 0x7FF) return DOUBLE_INF_BITS;
+    return (mantissa & ~((uint64_t)1 << 52)) | (uint64_t)power2 << 52;
 }
 
-static const char *phot_parse_hex4(const char *p, uint32_t *u)
+// 仅在有效数字超过 19 位且无法判定舍入方向时使用的定长大整数，按 32 位分段小端存储
+#define BIGNUM_LIMBS 128
+typedef struct {
+    uint32_t limb[BIGNUM_LIMBS];
+    size_t len;
+} phot_bignum;
+
+static void phot_bignum_mul_add(phot_bignum *b, uint32_t mul, uint32_t add)
 {
-    *u = 0;
-    for (int i = 0; i < 4; i++) {
-        char ch = *p++;
-        *u <<= 4;
-        if (ch >= '0' && ch <= '9') {
-            *u |= ch - '0';
-        } else if (ch >= 'A' && ch <= 'F') {
-            *u |= ch - ('A' - 10);
-        } else if (ch >= 'a' && ch <= 'f') {
-            *u |= ch - ('a' - 10);
-        } else
-            return NULL;
+    uint64_t carry = add;
+    for (size_t i = 0; i < b->len; i++) {
+        carry += (uint64_t)b->limb[i] * mul;
+        b->limb[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry != 0) {
+        assert(b->len < BIGNUM_LIMBS);
+        b->limb[b->len++] = (uint32_t)carry;
     }
-    return p;
 }
 
-static void phot_encode_utf8(phot_context *c, uint32_t u)
+static void phot_bignum_mul_pow5(phot_bignum *b, int64_t n)
 {
-    if (u <= 0x7F) {
-        phot_push_ch(c, u & 0xFF);
-    } else if (u <= 0x7FF) {
-        phot_push_ch(c, 0xC0 | ((u >> 6) & 0xFF));
-        phot_push_ch(c, 0x80 | (u & 0x3F));
-    } else if (u <= 0xFFFF) {
-        phot_push_ch(c, 0xE0 | ((u >> 12) & 0xFF));
-        phot_push_ch(c, 0x80 | ((u >> 6) & 0x3F));
-        phot_push_ch(c, 0x80 | (u & 0x3F));
-    } else {
-        assert(u <= 0x10FFFF);
-        phot_push_ch(c, 0xF0 | ((u >> 18) & 0xFF));
-        phot_push_ch(c, 0x80 | ((u >> 12) & 0x3F));
-        phot_push_ch(c, 0x80 | ((u >> 6) & 0x3F));
-        phot_push_ch(c, 0x80 | (u & 0x3F));
+    for (; n >= 13; n -= 13) {
+        phot_bignum_mul_add(b, 1220703125, 0);  // 5^13
     }
+    static const uint32_t small_pow5[] = {1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625};
+    phot_bignum_mul_add(b, small_pow5[n], 0);
 }
 
-#define STR_ERROR(ret)        \
-    do {                      \
-        c->top = initial_top; \
-        return ret;           \
-    } while (0)
+static void phot_bignum_shl(phot_bignum *b, int64_t n)
+{
+    if (b->len == 0) return;
+    size_t limbs = (size_t)(n / 32), bits = (size_t)(n % 32);
+    assert(b->len + limbs + 1 <= BIGNUM_LIMBS);
+    b->limb[b->len] = 0;
+    for (size_t i = b->len + 1; i-- > 0;) {
+        uint32_t v = b->limb[i] << bits;
+        if (bits != 0 && i > 0) {
+            v |= b->limb[i - 1] >> (32 - bits);
+        }
+        b->limb[i + limbs] = v;
+    }
+    memset(b->limb, 0, limbs * sizeof(uint32_t));
+    b->len += limbs + 1;
+    while (b->len > 0 && b->limb[b->len - 1] == 0) {
+        b->len--;
+    }
+}
 
-static int phot_parse_str_raw(phot_context *c, char **str, size_t *len)
+static int phot_bignum_cmp(const phot_bignum *a, const phot_bignum *b)
 {
-    const size_t initial_top = c->top;
-    expect(c, '"');
-    const char *const start = c->json;
-    const char *p = c->json;
+    if (a->len != b->len) return a->len > b->len ? 1 : -1;
+    for (size_t i = a->len; i-- > 0;) {
+        if (a->limb[i] != b->limb[i]) return a->limb[i] > b->limb[i] ? 1 : -1;
+    }
+    return 0;
+}
 
-    // 快速扫描无需转义的部分
-    while (*p != '"' && *p != '\\' && *p != '\0' && (unsigned char)*p >= 0x20) {
-        p++;
+typedef struct {
+    phot_bignum digits;  // 最多 NUM_BIG_DIGITS 位有效数字组成的整数
+    int64_t exp10;       // 末位有效数字对应的十进制指数
+    bool sticky;         // 是否还有被舍去的非零数字
+} phot_big_decimal;
+
+// 比较 d 与 bits 和 bits + 1 两个相邻 double 的中点
+static int phot_big_decimal_cmp_mid(const phot_big_decimal *d, uint64_t bits)
+{
+    uint64_t m[2];
+    int64_t e[2];
+    for (int i = 0; i < 2; i++, bits++) {
+        uint64_t biased = bits >> 52, frac = bits & (((uint64_t)1 << 52) - 1);
+        m[i] = biased == 0 ? frac : frac | (uint64_t)1 << 52;
+        e[i] = biased == 0 ? -1074 : (int64_t)biased - 1075;
     }
-    ptrdiff_t prelen = p - start;
-    // 若整个字符串都不需要特殊处理
-    if (*p == '"') {
-        *len = prelen;
-        *str = (char *)start;
-        c->json = p + 1;
-        return PHOT_PARSE_OK;
+    // 两者的指数至多相差 1，中点为 (m0 * 2^(e0 - k) + m1 * 2^(e1 - k)) * 2^(k - 1)
+    int64_t k = e[0] < e[1] ? e[0] : e[1];
+    uint64_t mid = (m[0] << (e[0] - k)) + (m[1] << (e[1] - k));
+    phot_bignum lhs = d->digits, rhs;
+    rhs.len = 0;
+    for (; mid != 0; mid >>= 32) {
+        rhs.limb[rhs.len++] = (uint32_t)mid;
     }
-    // 若存在需要特殊处理的字符
-    if (prelen > 0) {
-        // 将无需处理的部分先保存到栈里
-        memcpy(phot_context_push(c, prelen), start, prelen);
+    // 比较 digits * 5^exp10 * 2^exp10 与 rhs * 2^(k - 1)，先把 5 的幂乘到一侧，再对齐 2 的幂
+    if (d->exp10 >= 0) {
+        phot_bignum_mul_pow5(&lhs, d->exp10);
+    } else {
+        phot_bignum_mul_pow5(&rhs, -d->exp10);
     }
+    int64_t shift = d->exp10 - (k - 1);
+    if (shift >= 0) {
+        phot_bignum_shl(&lhs, shift);
+    } else {
+        phot_bignum_shl(&rhs, -shift);
+    }
+    int cmp = phot_bignum_cmp(&lhs, &rhs);
+    return cmp == 0 && d->sticky ? 1 : cmp;
+}
+
+// 精确地将 [p, end) 中的十进制数乘以 10^exp 舍入为 double，guess 为误差很小的初始估计
+static uint64_t phot_big_decimal_to_bits(const char *p, const char *end, int64_t exp, uint64_t guess)
+{
+    phot_big_decimal d;
+    d.digits.len = 0;
+    d.exp10 = exp;
+    d.sticky = false;
+    size_t nd = 0;
+    bool frac = false;
+    for (; p < end; p++) {
+        if (*p == '.') {
+            frac = true;
+            continue;
+        }
+        if (nd < NUM_BIG_DIGITS) {
+            phot_bignum_mul_add(&d.digits, 10, *p - '0');
+            if (d.digits.len > 0) {
+                nd++;
+            }
+            if (frac) {
+                d.exp10--;
+            }
+        } else {
+            d.sticky |= *p != '0';
+            if (!frac) {
+                d.exp10++;
+            }
+        }
+    }
+    // 在相邻的 double 之间移动，直到 d 落在当前值两侧中点之间
+    uint64_t bits = guess;
     while (1) {
-        uint32_t u;
+        int cmp = phot_big_decimal_cmp_mid(&d, bits);
+        if (cmp > 0) {
+            if (++bits == DOUBLE_INF_BITS) break;
+            continue;
+        }
+        if (cmp == 0) {
+            bits += bits & 1;
+            break;
+        }
+        if (bits == 0) break;
+        cmp = phot_big_decimal_cmp_mid(&d, bits - 1);
+        if (cmp < 0) {
+            bits--;
+            continue;
+        }
+        if (cmp == 0) {
+            bits -= bits & 1;
+        }
+        break;
+    }
+    return bits;
+}
+
+static int phot_parse_num(phot_context *c, phot_elem *e)
+{
+    const char *p = c->json;
+    const char *const end = c->end;
+    bool neg = false;
+    uint64_t w = 0;        // 前 19 位有效数字
+    int64_t q = 0;         // w 对应的十进制指数
+    int nd = 0;            // w 中的有效数字个数
+    bool dropped = false;  // 是否有非零数字因超过 19 位而被舍去
+    if (phot_at(p, end) == '-') {
+        neg = true;
+        p++;
+    }
+    const char *const digits = p;
+    if (phot_at(p, end) == '0') {
+        p++;
+    } else {
+        if (!is_digit_1to9(phot_at(p, end))) return PHOT_PARSE_INVALID_VALUE;
+        for (; is_digit(phot_at(p, end)); p++) {
+            if (nd < NUM_MAX_DIGITS) {
+                w = w * 10 + (*p - '0');
+                nd++;
+            } else {
+                dropped |= *p != '0';
+                q++;
+            }
+        }
+    }
+    if (phot_at(p, end) == '.') {
+        p++;
+        if (!is_digit(phot_at(p, end))) return PHOT_PARSE_INVALID_VALUE;
+        for (; is_digit(phot_at(p, end)); p++) {
+            if (nd < NUM_MAX_DIGITS) {
+                w = w * 10 + (*p - '0');
+                nd += w != 0;  // 小数点后的前导零不算有效数字
+                q--;
+            } else {
+                dropped |= *p != '0';
+            }
+        }
+    }
+    const char *const digits_end = p;
+    int64_t exp = 0;
+    if (phot_at(p, end) == 'e' || phot_at(p, end) == 'E') {
+        p++;
+        bool exp_neg = false;
+        if (phot_at(p, end) == '+' || phot_at(p, end) == '-') {
+            exp_neg = *p == '-';
+            p++;
+        }
+        if (!is_digit(phot_at(p, end))) return PHOT_PARSE_INVALID_VALUE;
+        for (; is_digit(phot_at(p, end)); p++) {
+            if (exp < 100000) {  // 再大的指数也只会得到 0 或溢出
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+        if (exp_neg) {
+            exp = -exp;
+        }
+    }
+    // 至此说明数字格式正确
+    q += exp;
+    uint64_t bits;
+    if (w == 0 || q < NUM_MIN_POW10) {
+        bits = 0;
+    } else if (q > NUM_MAX_POW10) {
+        bits = DOUBLE_INF_BITS;
+    }
+#if FLT_EVAL_METHOD == 0
+    // Clinger 快速路径：w 与 10^|q| 都能被精确表示时，一次浮点运算的结果就是正确舍入的
+    else if (!dropped && w <= (uint64_t)1 << 53 && q >= -22 && q <= 22) {
+        double d = (double)w;
+        d = q < 0 ? d / phot_pow10_exact[-q] : d * phot_pow10_exact[q];
+        e->num = neg ? -d : d;
+        c->json = p;
+        e->type = PHOT_NUM;
+        return PHOT_PARSE_OK;
+    }
+#endif
+    else {
+        bits = phot_eisel_lemire(w, q);
+        // 有数字被舍去时，真实值在 w 与 w + 1 之间，两者舍入结果不同才需要精确比较
+        if (dropped && phot_eisel_lemire(w + 1, q) != bits) {
+            bits = phot_big_decimal_to_bits(digits, digits_end, exp, bits);
+        }
+    }
+    if (bits == DOUBLE_INF_BITS) return PHOT_PARSE_NUM_TOO_BIG;
+    e->num = phot_bits_to_double(bits | (uint64_t)neg << 63);
+    c->json = p;
+    e->type = PHOT_NUM;
+    return PHOT_PARSE_OK;
+}
+
+static const char *phot_parse_hex4(const char *p, const char *end, uint32_t *u)
+{
+    if (end - p < 4) return NULL;
+    *u = 0;
+    for (int i = 0; i < 4; i++) {
         char ch = *p++;
-        switch (ch) {
-            case '"':
-                *len = c->top - initial_top;
-                *str = (char *)phot_context_pop(c, *len);
-                c->json = p;
+        *u <<= 4;
+        if (ch >= '0' && ch <= '9') {
+            *u |= ch - '0';
+        } else if (ch >= 'A' && ch <= 'F') {
+            *u |= ch - ('A' - 10);
+        } else if (ch >= 'a' && ch <= 'f') {
+            *u |= ch - ('a' - 10);
+        } else
+            return NULL;
+    }
+    return p;
+}
+
+// 将码点编码为 UTF-8 写入 buf，返回写入的字节数
+static size_t phot_encode_utf8(char *buf, uint32_t u)
+{
+    if (u <= 0x7F) {
+        buf[0] = u & 0xFF;
+        return 1;
+    } else if (u <= 0x7FF) {
+        buf[0] = 0xC0 | ((u >> 6) & 0xFF);
+        buf[1] = 0x80 | (u & 0x3F);
+        return 2;
+    } else if (u <= 0xFFFF) {
+        buf[0] = 0xE0 | ((u >> 12) & 0xFF);
+        buf[1] = 0x80 | ((u >> 6) & 0x3F);
+        buf[2] = 0x80 | (u & 0x3F);
+        return 3;
+    } else {
+        assert(u <= 0x10FFFF);
+        buf[0] = 0xF0 | ((u >> 18) & 0xFF);
+        buf[1] = 0x80 | ((u >> 12) & 0x3F);
+        buf[2] = 0x80 | ((u >> 6) & 0x3F);
+        buf[3] = 0x80 | (u & 0x3F);
+        return 4;
+    }
+}
+
+static inline const char *phot_min_ptr(const char *a, const char *b) { return a < b ? a : b; }
+
+static inline bool is_str_special(char ch)
+{
+    return ch == '"' || ch == '\\' || (unsigned char)ch < 0x20;
+}
+
+// 以下函数返回 [p, end) 中第一个需要特殊处理的字符（引号、反斜杠和控制字符）的位置，没有则返回 end
+// 按块扫描时每块只检查一次边界，最后不完整的块仍按对齐读取，只是丢弃越过 end 的结果
+static const char *phot_scan_str_scalar(const char *p, const char *end)
+{
+    // 离结尾足够远时每 4 个字节才检查一次边界
+    for (; end - p >= 4; p += 4) {
+        if (is_str_special(p[0])) return p;
+        if (is_str_special(p[1])) return p + 1;
+        if (is_str_special(p[2])) return p + 2;
+        if (is_str_special(p[3])) return p + 3;
+    }
+    while (p != end && !is_str_special(*p)) {
+        p++;
+    }
+    return p;
+}
+
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+// 若 v 中有字节小于 n 则返回非零值，n 不超过 128
+static inline uint64_t swar_less(uint64_t v, uint8_t n) { return (v - SWAR_ONES * n) & ~v & SWAR_HIGHS; }
+
+NO_SANITIZE_ADDRESS static const char *phot_scan_str_swar(const char *p, const char *end)
+{
+    // 先逐字节处理到 8 字节对齐，之后对齐的读取不会跨页
+    for (; (uintptr_t)p & 7; p++) {
+        if (p == end || is_str_special(*p)) return p;
+    }
+    for (; p < end; p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        if (swar_less(v ^ (SWAR_ONES * '"'), 1) | swar_less(v ^ (SWAR_ONES * '\\'), 1) | swar_less(v, 0x20)) {
+            return phot_scan_str_scalar(p, end);
+        }
+    }
+    return end;
+}
+
+#if PHOT_X86
+static inline unsigned phot_str_mask_sse2(__m128i v)
+{
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    __m128i bslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v);  // 无符号的 v <= 0x1F
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(quote, bslash), ctrl));
+}
+
+NO_SANITIZE_ADDRESS static const char *phot_scan_str_sse2(const char *p, const char *end)
+{
+    if (p >= end) return end;
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned mask = phot_str_mask_sse2(_mm_load_si128((const __m128i *)block)) >> (p - block);
+    if (mask != 0) return phot_min_ptr(p + __builtin_ctz(mask), end);
+    for (block += 16; block < end; block += 16) {
+        mask = phot_str_mask_sse2(_mm_load_si128((const __m128i *)block));
+        if (mask != 0) return phot_min_ptr(block + __builtin_ctz(mask), end);
+    }
+    return end;
+}
+
+__attribute__((target("avx2"))) static inline uint32_t phot_str_mask_avx2(__m256i v)
+{
+    __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    __m256i bslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    __m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(quote, bslash), ctrl));
+}
+
+__attribute__((target("avx2"))) NO_SANITIZE_ADDRESS static const char *phot_scan_str_avx2(const char *p, const char *end)
+{
+    if (p >= end) return end;
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)31);
+    uint32_t mask = phot_str_mask_avx2(_mm256_load_si256((const __m256i *)block)) >> (p - block);
+    if (mask != 0) return phot_min_ptr(p + __builtin_ctz(mask), end);
+    for (block += 32; block < end; block += 32) {
+        mask = phot_str_mask_avx2(_mm256_load_si256((const __m256i *)block));
+        if (mask != 0) return phot_min_ptr(block + __builtin_ctz(mask), end);
+    }
+    return end;
+}
+#endif
+
+static inline bool is_ws(char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; }
+
+// 以下函数返回 [p, end) 中第一个非空白字符的位置，没有则返回 end
+static const char *phot_skip_ws_scalar(const char *p, const char *end)
+{
+    while (p != end && is_ws(*p)) {
+        p++;
+    }
+    return p;
+}
+
+#if PHOT_X86
+static inline unsigned phot_ws_mask_sse2(__m128i v)
+{
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+    __m128i lf = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    __m128i cr = _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(space, tab), _mm_or_si128(lf, cr)));
+}
+
+NO_SANITIZE_ADDRESS static const char *phot_skip_ws_sse2(const char *p, const char *end)
+{
+    if (p >= end) return end;
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned mask = (~phot_ws_mask_sse2(_mm_load_si128((const __m128i *)block)) & 0xFFFF) >> (p - block);
+    if (mask != 0) return phot_min_ptr(p + __builtin_ctz(mask), end);
+    for (block += 16; block < end; block += 16) {
+        mask = ~phot_ws_mask_sse2(_mm_load_si128((const __m128i *)block)) & 0xFFFF;
+        if (mask != 0) return phot_min_ptr(block + __builtin_ctz(mask), end);
+    }
+    return end;
+}
+
+// 以低 4 位查表，只有空白字符会与表中对应的值相等，最高位为 1 的字节查表结果为 0
+__attribute__((target("sse4.2"))) static inline unsigned phot_ws_mask_sse42(__m128i v)
+{
+    const __m128i table = _mm_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_shuffle_epi8(table, v), v));
+}
+
+__attribute__((target("sse4.2"))) NO_SANITIZE_ADDRESS static const char *phot_skip_ws_sse42(const char *p, const char *end)
+{
+    if (p >= end) return end;
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned mask = (~phot_ws_mask_sse42(_mm_load_si128((const __m128i *)block)) & 0xFFFF) >> (p - block);
+    if (mask != 0) return phot_min_ptr(p + __builtin_ctz(mask), end);
+    for (block += 16; block < end; block += 16) {
+        mask = ~phot_ws_mask_sse42(_mm_load_si128((const __m128i *)block)) & 0xFFFF;
+        if (mask != 0) return phot_min_ptr(block + __builtin_ctz(mask), end);
+    }
+    return end;
+}
+
+__attribute__((target("avx2"))) static inline uint32_t phot_ws_mask_avx2(__m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0,  //
+                                           ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, v), v));
+}
+
+__attribute__((target("avx2"))) NO_SANITIZE_ADDRESS static const char *phot_skip_ws_avx2(const char *p, const char *end)
+{
+    if (p >= end) return end;
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)31);
+    uint32_t mask = ~phot_ws_mask_avx2(_mm256_load_si256((const __m256i *)block)) >> (p - block);
+    if (mask != 0) return phot_min_ptr(p + __builtin_ctz(mask), end);
+    for (block += 32; block < end; block += 32) {
+        mask = ~phot_ws_mask_avx2(_mm256_load_si256((const __m256i *)block));
+        if (mask != 0) return phot_min_ptr(block + __builtin_ctz(mask), end);
+    }
+    return end;
+}
+#endif
+
+// 以下按 64 字节一块识别字符串的内外，结构索引和跳过整个数组或对象都用到它们
+#if PHOT_X86
+__attribute__((target("avx2"))) static inline uint64_t phot_eq_mask_avx2(__m256i lo, __m256i hi, char ch)
+{
+    __m256i c = _mm256_set1_epi8(ch);
+    uint32_t l = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c));
+    uint32_t h = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c));
+    return (uint64_t)h << 32 | l;
+}
+#endif
+
+// 返回被反斜杠转义的字符的位图，只在有反斜杠时逐个处理，carry 传入并传出跨块的转义
+static inline uint64_t phot_escaped_mask(uint64_t bslash, uint64_t *carry)
+{
+    uint64_t escaped = *carry;
+    *carry = 0;
+    while (bslash != 0) {
+        int i = __builtin_ctzll(bslash);
+        bslash &= bslash - 1;
+        if (escaped >> i & 1) continue;  // 被转义的反斜杠不转义下一个字符
+        if (i == 63) {
+            *carry = 1;
+        } else {
+            escaped |= (uint64_t)1 << (i + 1);
+        }
+    }
+    return escaped;
+}
+
+// 前缀异或：从开引号（含）到闭引号（不含）之间的位为 1
+static inline uint64_t phot_prefix_xor(uint64_t quote)
+{
+    quote ^= quote << 1;
+    quote ^= quote << 2;
+    quote ^= quote << 4;
+    quote ^= quote << 8;
+    quote ^= quote << 16;
+    quote ^= quote << 32;
+    return quote;
+}
+
+// 不足一块的尾部复制到 buf 并补上空白，空白不会产生 token
+static inline const char *phot_index_tail(const char *p, size_t n, char *buf)
+{
+    memcpy(buf, p, n);
+    memset(buf + n, ' ', 64 - n);
+    return buf;
+}
+
+#if PHOT_USE_INDEX_BACKEND
+static inline bool is_op(char ch) { return ch == '{' || ch == '}' || ch == '[' || ch == ']' || ch == ':' || ch == ','; }
+
+// 结构索引第一阶段的字符分类，每一位对应 64 字节块中的一个字节
+typedef struct {
+    uint64_t quote;   // 引号
+    uint64_t bslash;  // 反斜杠
+    uint64_t ws;      // 空白
+    uint64_t op;      // 结构字符 {}[]:,
+} phot_block;
+
+static inline void phot_classify_scalar(const char *p, phot_block *b)
+{
+    b->quote = b->bslash = b->ws = b->op = 0;
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        char ch = p[i];
+        if (ch == '"') {
+            b->quote |= bit;
+        } else if (ch == '\\') {
+            b->bslash |= bit;
+        } else if (is_ws(ch)) {
+            b->ws |= bit;
+        } else if (is_op(ch)) {
+            b->op |= bit;
+        }
+    }
+}
+
+#if PHOT_X86
+__attribute__((target("avx2"))) static inline uint32_t phot_op_mask_avx2(__m256i v)
+{
+    // '[' 与 ']' 加上 0x20 后分别是 '{' 与 '}'，没有其它字符会变成这两个
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')),
+                                                 _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+                                 _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                                                 _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+    return (uint32_t)_mm256_movemask_epi8(op);
+}
+
+__attribute__((target("avx2"))) static inline void phot_classify_avx2(const char *p, phot_block *b)
+{
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+    b->quote = phot_eq_mask_avx2(lo, hi, '"');
+    b->bslash = phot_eq_mask_avx2(lo, hi, '\\');
+    b->ws = (uint64_t)phot_ws_mask_avx2(hi) << 32 | phot_ws_mask_avx2(lo);
+    b->op = (uint64_t)phot_op_mask_avx2(hi) << 32 | phot_op_mask_avx2(lo);
+}
+#endif
+
+// 结构索引：第一阶段把输入按 64 字节一块分类成位图，算出哪些字符在字符串内，记下每个 token 的起始位置；
+// 第二阶段仍由同一套语法驱动，只是跳过空白时直接取下一个 token 的位置
+// 索引按窗口分段建立，第二阶段用完一个窗口再分类下一个，所以索引始终留在缓存中，占用的内存也与输入大小无关
+struct phot_index {
+    const char *base;   // 当前窗口的起始位置
+    const char *next;   // 尚未分类的输入的起始位置
+    size_t count, cur;  // 当前窗口中 token 的个数和下一个待取的下标
+    uint64_t escaped;   // 上一块末尾的反斜杠转义了本块的第一个字符时为 1
+    uint64_t in_str;    // 上一块结束时在字符串内则为全 1，否则为 0
+    uint64_t boundary;  // 上一块的最后一个字符是空白、结构字符或引号时为 1
+    uint16_t slots[PHOT_INDEX_WINDOW + 8];  // token 相对于 base 的偏移，末尾留出一次多写的余量
+};
+
+// token 的起始位置包括字符串外的结构字符、开引号，以及紧跟在空白、结构字符或引号之后的其它字符
+// 后者是数字和字面量的开头，也可能是非法字符，它们都交给第二阶段判断
+static inline void phot_index_block(phot_index *ix, const phot_block *b, size_t offset)
+{
+    uint64_t quote = b->quote & ~phot_escaped_mask(b->bslash, &ix->escaped);
+    uint64_t in_str = phot_prefix_xor(quote) ^ ix->in_str;
+    ix->in_str = (uint64_t)((int64_t)in_str >> 63);
+    uint64_t boundary = b->ws | b->op | quote;
+    uint64_t follows = boundary << 1 | ix->boundary;
+    ix->boundary = boundary >> 63;
+    uint64_t starts = ((b->op | (follows & ~boundary)) & ~in_str) | (quote & in_str);
+    // 每次无条件写出 8 个位置再按实际个数前进，多写的部分在 slots 末尾留有余量；位图取空后 ctz 的结果无意义但不会被用到
+    size_t count = __builtin_popcountll(starts);
+    uint16_t *out = ix->slots + ix->count;
+    for (size_t i = 0; i < count; i += 8) {
+        for (int k = 0; k < 8; k++) {
+            out[i + k] = (uint16_t)(offset + __builtin_ctzll(starts | (uint64_t)1 << 63));
+            starts &= starts - 1;
+        }
+    }
+    ix->count += count;
+}
+
+// 以下函数对 [ix->base, ix->base + n) 建立索引
+static void phot_index_scan_scalar(phot_index *ix, size_t n)
+{
+    phot_block b;
+    size_t offset = 0;
+    for (; n - offset >= 64; offset += 64) {
+        phot_classify_scalar(ix->base + offset, &b);
+        phot_index_block(ix, &b, offset);
+    }
+    if (offset < n) {
+        char buf[64];
+        phot_classify_scalar(phot_index_tail(ix->base + offset, n - offset, buf), &b);
+        phot_index_block(ix, &b, offset);
+    }
+}
+
+#if PHOT_X86
+__attribute__((target("avx2,popcnt"))) static void phot_index_scan_avx2(phot_index *ix, size_t n)
+{
+    phot_block b;
+    size_t offset = 0;
+    for (; n - offset >= 64; offset += 64) {
+        phot_classify_avx2(ix->base + offset, &b);
+        phot_index_block(ix, &b, offset);
+    }
+    if (offset < n) {
+        char buf[64];
+        phot_classify_avx2(phot_index_tail(ix->base + offset, n - offset, buf), &b);
+        phot_index_block(ix, &b, offset);
+    }
+}
+#endif
+#endif  // PHOT_USE_INDEX_BACKEND
+
+// 跳过整个数组或对象：同样按 64 字节一块算出字符串外的括号，逐块累计嵌套深度，
+// 只有本块的右括号多到可能让深度归零时才逐个查看
+typedef struct {
+    uint64_t quote;   // 引号
+    uint64_t bslash;  // 反斜杠
+    uint64_t open;    // 左括号 [{
+    uint64_t close;   // 右括号 ]}
+} phot_nest_block;
+
+typedef struct {
+    uint64_t escaped;  // 上一块末尾的反斜杠转义了本块的第一个字符时为 1
+    uint64_t in_str;   // 上一块结束时在字符串内则为全 1，否则为 0
+    size_t depth;      // 尚未闭合的括号数
+} phot_nest;
+
+static inline void phot_classify_nest_scalar(const char *p, phot_nest_block *b)
+{
+    b->quote = b->bslash = b->open = b->close = 0;
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        char ch = p[i];
+        if (ch == '"') {
+            b->quote |= bit;
+        } else if (ch == '\\') {
+            b->bslash |= bit;
+        } else if (ch == '[' || ch == '{') {
+            b->open |= bit;
+        } else if (ch == ']' || ch == '}') {
+            b->close |= bit;
+        }
+    }
+}
+
+#if PHOT_X86
+__attribute__((target("avx2"))) static inline void phot_classify_nest_avx2(const char *p, phot_nest_block *b)
+{
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+    b->quote = phot_eq_mask_avx2(lo, hi, '"');
+    b->bslash = phot_eq_mask_avx2(lo, hi, '\\');
+    __m256i lower_lo = _mm256_or_si256(lo, _mm256_set1_epi8(0x20));
+    __m256i lower_hi = _mm256_or_si256(hi, _mm256_set1_epi8(0x20));
+    b->open = phot_eq_mask_avx2(lower_lo, lower_hi, '{');
+    b->close = phot_eq_mask_avx2(lower_lo, lower_hi, '}');
+}
+#endif
+
+// 返回深度归零处在块内的下标，没有归零时返回 64
+static inline int phot_nest_block_step(phot_nest *n, const phot_nest_block *b)
+{
+    uint64_t quote = b->quote & ~phot_escaped_mask(b->bslash, &n->escaped);
+    uint64_t in_str = phot_prefix_xor(quote) ^ n->in_str;
+    n->in_str = (uint64_t)((int64_t)in_str >> 63);
+    uint64_t open = b->open & ~in_str, close = b->close & ~in_str;
+    if ((size_t)__builtin_popcountll(close) < n->depth) {
+        n->depth = n->depth + __builtin_popcountll(open) - __builtin_popcountll(close);
+        return 64;
+    }
+    for (uint64_t both = open | close; both != 0; both &= both - 1) {
+        int i = __builtin_ctzll(both);
+        if (open >> i & 1) {
+            n->depth++;
+        } else if (--n->depth == 0) {
+            return i;
+        }
+    }
+    return 64;
+}
+
+// 以下函数中 p 指向左括号，返回与之配对的右括号之后的位置，到 end 仍未配对时返回 NULL
+// 只数括号不管种类，种类是否匹配留给展开这一层时的语法检查
+static const char *phot_skip_nest_scalar(const char *p, const char *end)
+{
+    phot_nest n = {0, 0, 1};
+    phot_nest_block b;
+    int i;
+    for (p++; end - p >= 64; p += 64) {
+        phot_classify_nest_scalar(p, &b);
+        if ((i = phot_nest_block_step(&n, &b)) < 64) return p + i + 1;
+    }
+    if (p < end) {
+        char buf[64];
+        phot_classify_nest_scalar(phot_index_tail(p, end - p, buf), &b);
+        if ((i = phot_nest_block_step(&n, &b)) < 64) return p + i + 1;
+    }
+    return NULL;
+}
+
+#if PHOT_X86
+__attribute__((target("avx2,popcnt"))) static const char *phot_skip_nest_avx2(const char *p, const char *end)
+{
+    phot_nest n = {0, 0, 1};
+    phot_nest_block b;
+    int i;
+    for (p++; end - p >= 64; p += 64) {
+        phot_classify_nest_avx2(p, &b);
+        if ((i = phot_nest_block_step(&n, &b)) < 64) return p + i + 1;
+    }
+    if (p < end) {
+        char buf[64];
+        phot_classify_nest_avx2(phot_index_tail(p, end - p, buf), &b);
+        if ((i = phot_nest_block_step(&n, &b)) < 64) return p + i + 1;
+    }
+    return NULL;
+}
+#endif
+
+// x86-64 上 SSE2 是基线，SSE4.2 和 AVX2 在加载时按 CPU 支持情况选用
+#if PHOT_X86
+static phot_simd phot_simd_level = PHOT_SIMD_SSE2;
+static const char *(*phot_scan_str)(const char *p, const char *end) = phot_scan_str_sse2;
+static const char *(*phot_skip_ws)(const char *p, const char *end) = phot_skip_ws_sse2;
+#if PHOT_USE_INDEX_BACKEND
+static void (*phot_index_scan)(phot_index *ix, size_t n) = phot_index_scan_scalar;
+#endif
+static const char *(*phot_skip_nest)(const char *p, const char *end) = phot_skip_nest_scalar;
+#else
+static phot_simd phot_simd_level = PHOT_SIMD_SWAR;
+static const char *(*phot_scan_str)(const char *p, const char *end) = phot_scan_str_swar;
+static const char *(*phot_skip_ws)(const char *p, const char *end) = phot_skip_ws_scalar;
+#if PHOT_USE_INDEX_BACKEND
+static void (*phot_index_scan)(phot_index *ix, size_t n) = phot_index_scan_scalar;
+#endif
+static const char *(*phot_skip_nest)(const char *p, const char *end) = phot_skip_nest_scalar;
+#endif
+
+static phot_simd phot_simd_supported(void)
+{
+#if PHOT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return PHOT_SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return PHOT_SIMD_SSE42;
+    return PHOT_SIMD_SSE2;
+#else
+    return PHOT_SIMD_SWAR;
+#endif
+}
+
+phot_simd phot_set_simd(phot_simd simd)
+{
+    phot_simd supported = phot_simd_supported();
+    if (simd > supported) {
+        simd = supported;
+    }
+#if PHOT_USE_INDEX_BACKEND
+    phot_index_scan = phot_index_scan_scalar;
+#endif
+    phot_skip_nest = phot_skip_nest_scalar;
+    switch (simd) {
+        case PHOT_SIMD_SCALAR:
+            phot_scan_str = phot_scan_str_scalar;
+            phot_skip_ws = phot_skip_ws_scalar;
+            break;
+        case PHOT_SIMD_SWAR:
+            phot_scan_str = phot_scan_str_swar;
+            phot_skip_ws = phot_skip_ws_scalar;
+            break;
+#if PHOT_X86
+        case PHOT_SIMD_SSE2:
+            phot_scan_str = phot_scan_str_sse2;
+            phot_skip_ws = phot_skip_ws_sse2;
+            break;
+        case PHOT_SIMD_SSE42:
+            phot_scan_str = phot_scan_str_sse2;
+            phot_skip_ws = phot_skip_ws_sse42;
+            break;
+        case PHOT_SIMD_AVX2:
+            phot_scan_str = phot_scan_str_avx2;
+            phot_skip_ws = phot_skip_ws_avx2;
+#if PHOT_USE_INDEX_BACKEND
+            phot_index_scan = phot_index_scan_avx2;
+#endif
+            phot_skip_nest = phot_skip_nest_avx2;
+            break;
+#endif
+        default:
+            assert(0 && "invalid simd level");
+    }
+    return phot_simd_level = simd;
+}
+
+phot_simd phot_get_simd(void) { return phot_simd_level; }
+
+void phot_set_allocator(const phot_allocator *alloc)
+{
+    if (alloc == NULL) {
+        phot_allocator_global = (phot_allocator){phot_default_alloc, phot_default_realloc, phot_default_free, NULL};
+        return;
+    }
+    assert(alloc->alloc != NULL && alloc->realloc != NULL && alloc->free != NULL);
+    phot_allocator_global = *alloc;
+}
+
+const phot_allocator *phot_get_allocator(void) { return &phot_allocator_global; }
+
+bool phot_get_parse_stats(phot_parse_stats *stats)
+{
+    assert(stats != NULL);
+#if PHOT_USE_STATS
+    *stats = phot_stats_last;
+    return true;
+#else
+    memset(stats, 0, sizeof(*stats));
+    return false;
+#endif
+}
+
+#if PHOT_X86
+__attribute__((constructor)) static void phot_simd_init(void) { phot_set_simd(PHOT_SIMD_AVX2); }
+#endif
+
+static phot_backend phot_backend_kind = PHOT_BACKEND_DESCENT;
+
+phot_backend phot_set_backend(phot_backend backend)
+{
+    assert(backend == PHOT_BACKEND_DESCENT || backend == PHOT_BACKEND_INDEX);
+#if !PHOT_USE_INDEX_BACKEND
+    backend = PHOT_BACKEND_DESCENT;
+#endif
+    return phot_backend_kind = backend;
+}
+
+phot_backend phot_get_backend(void) { return phot_backend_kind; }
+
+// 解析允许的最大嵌套深度，不限制时为 SIZE_MAX
+static size_t phot_max_depth = PHOT_PARSE_MAX_DEPTH;
+
+void phot_set_max_depth(size_t depth) { phot_max_depth = depth != 0 ? depth : SIZE_MAX; }
+
+size_t phot_get_max_depth(void) { return phot_max_depth != SIZE_MAX ? phot_max_depth : 0; }
+
+#if PHOT_USE_INDEX_BACKEND
+// 为下一个窗口建立索引，输入已经全部分类时返回 false
+static bool phot_index_fill(phot_index *ix, const char *end)
+{
+    if (ix->next == end) return false;
+    size_t n = (size_t)(end - ix->next) < PHOT_INDEX_WINDOW ? (size_t)(end - ix->next) : PHOT_INDEX_WINDOW;
+    ix->base = ix->next;
+    ix->count = ix->cur = 0;
+#if PHOT_USE_STATS
+    double begin = phot_stats_now();
+    phot_index_scan(ix, n);
+    PHOT_STAT(index_seconds += phot_stats_now() - begin);
+#else
+    phot_index_scan(ix, n);
+#endif
+    ix->next = ix->base + n;
+    return true;
+}
+
+// 代替跳过空白：取 c->json 处或之后的第一个 token
+// 两者之间不会有 token 的起始位置，所以其中的非空白字符只能紧接在 c->json 处，例如 "truex" 中的 'x'
+static void phot_index_skip_ws_slow(phot_context *c)
+{
+    phot_index *ix = c->index;
+    const char *p = c->json;
+    const char *t = c->end;
+    do {
+        for (; ix->cur < ix->count; ix->cur++) {
+            const char *slot = ix->base + ix->slots[ix->cur];
+            if (slot >= p) {
+                t = slot;
+                goto found;
+            }
+        }
+    } while (phot_index_fill(ix, c->end));
+found:
+    c->json = p == t || is_ws(*p) ? t : p;
+}
+
+// 刚解析完的 token 通常就是当前槽位，下一个槽位即是答案
+static inline void phot_index_skip_ws(phot_context *c)
+{
+    phot_index *ix = c->index;
+    const char *p = c->json;
+    size_t cur = ix->cur;
+    if (LIKELY(cur + 1 < ix->count)) {
+        const char *slot = ix->base + ix->slots[cur];
+        const char *next = ix->base + ix->slots[cur + 1];
+        if (slot < p && next >= p) {
+            ix->cur = cur + 1;
+            c->json = p == next || is_ws(*p) ? next : p;
+            return;
+        }
+    }
+    phot_index_skip_ws_slow(c);
+}
+#endif
+
+static inline void phot_parse_whitespace(phot_context *c)
+{
+#if PHOT_USE_INDEX_BACKEND
+    if (c->index != NULL) {
+        phot_index_skip_ws(c);
+        return;
+    }
+#endif
+    const char *p = c->json;
+    // 压缩过的 JSON 中 token 之间通常没有空白，美化过的则多是单个空格
+    if (LIKELY(!is_ws(phot_at(p, c->end)))) return;
+    if (*p == ' ' && !is_ws(phot_at(p + 1, c->end))) {
+        c->json = p + 1;
+        return;
+    }
+    // 其余情况多是换行加缩进，跳过换行后整段交给按块扫描的实现
+    c->json = phot_skip_ws(p + 1, c->end);
+}
+
+// 字符串解码的输出位置：原地解析时 *w 指向输入缓冲区，否则压入 context 栈
+// 转义序列解码后只会变短，所以原地写入永远不会越过读取位置
+static inline char *phot_str_out(phot_context *c, char **w, size_t size)
+{
+    if (*w != NULL) {
+        char *ret = *w;
+        *w += size;
+        return ret;
+    }
+    return (char *)phot_context_push(c, size);
+}
+
+#define STR_ERROR(ret)        \
+    do {                      \
+        c->top = initial_top; \
+        return ret;           \
+    } while (0)
+
+// 原地解析时返回的字符串位于输入缓冲区内且以 '\0' 结尾，否则位于 context 栈上
+static int phot_parse_str_raw(phot_context *c, char **str, size_t *len)
+{
+    const size_t initial_top = c->top;
+    expect(c, '"');
+    char *const start = (char *)c->json;
+    const char *const end = c->end;
+    const char *p = c->json;
+
+    // 快速扫描无需转义的部分
+    p = phot_scan_str(p, end);
+    ptrdiff_t prelen = p - start;
+    // 若整个字符串都不需要特殊处理
+    if (LIKELY(p != end && *p == '"')) {
+        if (UNLIKELY(!phot_len_fits(prelen))) return PHOT_PARSE_TOO_LONG;
+        if (c->insitu) {
+            start[prelen] = '\0';
+        }
+        *len = prelen;
+        *str = start;
+        c->json = p + 1;
+        PHOT_STAT(strs_fast++);
+        return PHOT_PARSE_OK;
+    }
+    // 若存在需要特殊处理的字符，原地解析时前缀已在正确位置，否则先保存到栈里
+    char *w = NULL;
+    if (c->insitu) {
+        w = (char *)p;
+    } else if (prelen > 0) {
+        memcpy(phot_context_push(c, prelen), start, prelen);
+    }
+    while (1) {
+        uint32_t u;
+        char buf[4];
+        if (UNLIKELY(p == end)) {
+            STR_ERROR(PHOT_PARSE_MISS_QUOTATION_MARK);
+        }
+        switch (*p++) {
+            case '"':
+                if (UNLIKELY(!phot_len_fits(c->insitu ? (size_t)(w - start) : c->top - initial_top))) {
+                    STR_ERROR(PHOT_PARSE_TOO_LONG);
+                }
+                if (c->insitu) {
+                    *w = '\0';
+                    *len = w - start;
+                    *str = start;
+                } else {
+                    *len = c->top - initial_top;
+                    *str = (char *)phot_context_pop(c, *len);
+                }
+                c->json = p;
+                PHOT_STAT(strs_escaped++);
+                return PHOT_PARSE_OK;
+            case '\\':
+                switch (p != end ? *p++ : '\0') {
+                    case '"':
+                        *phot_str_out(c, &w, 1) = '"';
+                        break;
+                    case '\\':
+                        *phot_str_out(c, &w, 1) = '\\';
+                        break;
+                    case '/':
+                        *phot_str_out(c, &w, 1) = '/';
+                        break;
+                    case 'b':
+                        *phot_str_out(c, &w, 1) = '\b';
+                        break;
+                    case 'f':
+                        *phot_str_out(c, &w, 1) = '\f';
+                        break;
+                    case 'n':
+                        *phot_str_out(c, &w, 1) = '\n';
+                        break;
+                    case 'r':
+                        *phot_str_out(c, &w, 1) = '\r';
+                        break;
+                    case 't':
+                        *phot_str_out(c, &w, 1) = '\t';
+                        break;
+                    case 'u':
+                        if ((p = phot_parse_hex4(p, end, &u)) == NULL) {
+                            STR_ERROR(PHOT_PARSE_INVALID_UNICODE_HEX);
+                        }
+                        if (u >= 0xD800 && u <= 0xDBFF) {  // 处理代理对
+                            if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_SURROGATE);
+                            }
+                            uint32_t u2;
+                            if ((p = phot_parse_hex4(p + 2, end, &u2)) == NULL) {
+                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_HEX);
+                            }
+                            if (u2 < 0xDC00 || u2 > 0xDFFF) {
+                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_SURROGATE);
+                            }
+                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+                        }
+                        size_t n = phot_encode_utf8(buf, u);
+                        memcpy(phot_str_out(c, &w, n), buf, n);
+                        break;
+                    default:
+                        STR_ERROR(PHOT_PARSE_INVALID_STR_ESCAPE);
+                }
+                break;
+            default:
+                STR_ERROR(PHOT_PARSE_INVALID_STR_CHAR);
+        }
+        // 整段拷贝下一个特殊字符之前的部分
+        const char *run = p;
+        p = phot_scan_str(p, end);
+        if (p > run) {
+            memmove(phot_str_out(c, &w, p - run), run, p - run);
+        }
+    }
+}
+
+// 保存解析出的字符串，原地解析时直接使用输入缓冲区
+static char *phot_context_str(phot_context *c, char *str, size_t len)
+{
+    if (c->insitu) {
+        return str;
+    }
+    char *ret = (char *)phot_context_alloc(c, len + 1, 1);
+    memcpy(ret, str, len);
+    ret[len] = '\0';
+    return ret;
+}
+
+// 文档模式或原地解析时，解析出的字符串和键都不归元素所有
+static inline bool phot_context_borrows_str(const phot_context *c) { return c->doc != NULL || c->insitu; }
+
+// 把解析出的字符串写进元素，短字符串存放在元素内，不占用 arena 或堆
+// 原地解析本来就不分配，保持字符串总是指向输入缓冲区
+static void phot_context_set_str(phot_context *c, phot_elem *e, char *str, size_t len)
+{
+    if (len <= PHOT_SSO_MAX && !c->insitu) {
+        phot_str_inline(e, str, len);
+        return;
+    }
+    e->str = phot_context_str(c, str, len);
+    e->len = phot_len32(len);
+    e->type = PHOT_STR;
+    e->flags = phot_context_borrows_str(c) ? PHOT_FLAG_BORROWED : 0;
+}
+
+// 对象的哈希索引：开放寻址、线性探测，槽的低 32 位保存成员下标加一，0 表示空槽；
+// 高 32 位保存键的哈希值的高位，探测时先比较它，很少需要读取成员的键
+// 成员数达到 PHOT_OBJ_INDEX_THRESHOLD 时才建立，较小的对象仍然顺序查找
+typedef struct {
+    size_t mask;  // 槽数减一，槽数为 2 的幂
+    uint64_t slots[];
+} phot_obj_index;
+
+// 元素数组前的头部，与元素数组一起分配，其余成员只是为了让元素数组保持对齐
+typedef union {
+    uint32_t cap;
+    double align_num;
+    size_t align_size;
+} phot_arr_head;
+
+static inline phot_arr_head *phot_arr_head_of(const phot_elem *e) { return (phot_arr_head *)e->arr - 1; }
+
+static inline size_t phot_arr_cap(const phot_elem *e) { return e->arr != NULL ? phot_arr_head_of(e)->cap : 0; }
+
+// 容量为 cap 的元素数组连同头部的字节数
+static inline size_t phot_arr_size(size_t cap) { return sizeof(phot_arr_head) + cap * sizeof(phot_elem); }
+
+// 分配或调整带头部的元素数组
+static phot_elem *phot_arr_realloc(phot_elem *arr, size_t cap)
+{
+    phot_arr_head *head = arr != NULL ? (phot_arr_head *)arr - 1 : NULL;
+    size_t old_size = head != NULL ? phot_arr_size(head->cap) : 0;
+    head = (phot_arr_head *)phot_mem_realloc(head, old_size, phot_arr_size(cap));
+    assert(head != NULL);
+    head->cap = phot_len32(cap);
+    return (phot_elem *)(head + 1);
+}
+
+// 成员数组前的头部，同样与成员数组一起分配
+typedef union {
+    struct {
+        phot_obj_index *index;
+        uint32_t cap;
+    };
+    double align_num;
+    size_t align_size;
+} phot_obj_head;
+
+static inline phot_obj_head *phot_obj_head_of(const phot_elem *e) { return (phot_obj_head *)e->obj - 1; }
+
+static inline phot_obj_index **phot_obj_index_of(const phot_elem *e) { return &phot_obj_head_of(e)->index; }
+
+static inline size_t phot_obj_cap(const phot_elem *e) { return e->obj != NULL ? phot_obj_head_of(e)->cap : 0; }
+
+// 容量为 cap 的成员数组连同头部的字节数
+static inline size_t phot_obj_size(size_t cap) { return sizeof(phot_obj_head) + cap * sizeof(phot_member); }
+
+// 分配或调整带头部的成员数组，新分配的数组没有索引
+static phot_member *phot_obj_realloc(phot_member *obj, size_t cap)
+{
+    phot_obj_head *head = obj != NULL ? (phot_obj_head *)obj - 1 : NULL;
+    bool fresh = head == NULL;
+    size_t old_size = head != NULL ? phot_obj_size(head->cap) : 0;
+    head = (phot_obj_head *)phot_mem_realloc(head, old_size, phot_obj_size(cap));
+    assert(head != NULL);
+    if (fresh) {
+        head->index = NULL;
+    }
+    head->cap = phot_len32(cap);
+    return (phot_member *)(head + 1);
+}
+
+// 驻留的键可以先比较地址
+static inline bool phot_key_eq(const phot_elem *k, const char *key, size_t klen)
+{
+    const char *p = phot_str_ptr(k);
+    return phot_str_len(k) == klen && (p == key || memcmp(p, key, klen) == 0);
+}
+
+static inline uint64_t phot_hash_mix(uint64_t a, uint64_t b)
+{
+    uint64_t hi, lo = phot_umul128(a, b, &hi);
+    return hi ^ lo;
+}
+
+static inline uint64_t phot_load64(const char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t phot_load32(const char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 每次吸收 16 个字节，用 128 位乘积的高低两半折叠混合；最后不足 16 个字节时用可以重叠的定长读取取出，
+// 常见的短键只需要一次乘法，也不必调用变长的 memcpy
+static uint64_t phot_hash_key(const char *key, size_t klen)
+{
+    uint64_t h = klen ^ 0xA0761D6478BD642FULL, a, b;
+    if (klen > 16) {
+        const char *end = key + klen;
+        for (; end - key > 16; key += 16) {
+            h = phot_hash_mix(phot_load64(key) ^ 0xE7037ED1A0B428DBULL, phot_load64(key + 8) ^ h);
+        }
+        a = phot_load64(end - 16);
+        b = phot_load64(end - 8);
+    } else if (klen >= 8) {
+        a = phot_load64(key);
+        b = phot_load64(key + klen - 8);
+    } else if (klen >= 4) {
+        a = phot_load32(key);
+        b = phot_load32(key + klen - 4);
+    } else if (klen > 0) {
+        a = (uint64_t)(uint8_t)key[0] << 16 | (uint64_t)(uint8_t)key[klen >> 1] << 8 | (uint8_t)key[klen - 1];
+        b = 0;
+    } else {
+        a = b = 0;
+    }
+    return phot_hash_mix(a ^ 0xE7037ED1A0B428DBULL, b ^ h);
+}
+
+// 负载因子不超过 1/2
+static inline size_t phot_obj_index_slots(size_t len)
+{
+    size_t n = 16;
+    while (n < len * 2) {
+        n <<= 1;
+    }
+    return n;
+}
+
+static inline size_t phot_obj_index_size(size_t slots) { return sizeof(phot_obj_index) + slots * sizeof(uint64_t); }
+
+static inline void phot_obj_index_free(phot_obj_index *index)
+{
+    if (index != NULL) {
+        phot_mem_free(index, phot_obj_index_size(index->mask + 1));
+    }
+}
+
+// 返回键所在的槽，若不存在则返回应当插入的空槽
+static uint64_t *phot_obj_index_probe(phot_obj_index *index, const phot_member *obj, const char *key, size_t klen,
+                                      uint64_t hash)
+{
+    uint64_t tag = hash & ~(uint64_t)UINT32_MAX;
+    for (size_t pos = (size_t)hash & index->mask;; pos = (pos + 1) & index->mask) {
+        uint64_t slot = index->slots[pos];
+        if (slot == 0) return &index->slots[pos];
+        if ((slot & ~(uint64_t)UINT32_MAX) == tag && phot_key_eq(&obj[(uint32_t)slot - 1].key, key, klen)) {
+            return &index->slots[pos];
+        }
+    }
+}
+
+// 返回键所在成员的下标
+static size_t phot_obj_index_find(phot_obj_index *index, const phot_member *obj, const char *key, size_t klen)
+{
+    uint64_t slot = *phot_obj_index_probe(index, obj, key, klen, phot_hash_key(key, klen));
+    return slot != 0 ? (uint32_t)slot - 1 : PHOT_KEY_NOT_EXIST;
+}
+
+// 登记下标为 i 的成员，键已经登记过时保留先前的成员
+static inline void phot_obj_index_add(phot_obj_index *index, const phot_member *obj, size_t i)
+{
+    const char *key = phot_str_ptr(&obj[i].key);
+    size_t klen = phot_str_len(&obj[i].key);
+    uint64_t hash = phot_hash_key(key, klen);
+    uint64_t *slot = phot_obj_index_probe(index, obj, key, klen, hash);
+    if (*slot == 0) {
+        *slot = (hash & ~(uint64_t)UINT32_MAX) | (i + 1);
+    }
+}
+
+// 为 len 个成员填充索引，重复的键只登记第一个，与顺序查找的结果一致
+static void phot_obj_index_fill(phot_obj_index *index, size_t slots, const phot_member *obj, size_t len)
+{
+    index->mask = slots - 1;
+    memset(index->slots, 0, slots * sizeof(uint64_t));
+    for (size_t i = 0; i < len; i++) {
+        phot_obj_index_add(index, obj, i);
+    }
+}
+
+// 释放对象自己持有的索引，借用的缓冲区的索引在 arena 里，只需要丢弃
+static void phot_obj_index_drop(phot_elem *e)
+{
+    if (e->obj != NULL) {
+        phot_obj_index **index = phot_obj_index_of(e);
+        if (!(e->flags & PHOT_FLAG_BORROWED)) {
+            phot_obj_index_free(*index);
+        }
+        *index = NULL;
+    }
+}
+
+// 在堆上为成员足够多的对象建立索引，调用前对象不能持有索引
+// 借用的缓冲区的索引只能在解析时建在 arena 里，这里不为它们建立，查找退回顺序查找
+static void phot_obj_index_build(phot_elem *e)
+{
+    if (e->len < PHOT_OBJ_INDEX_THRESHOLD || (e->flags & PHOT_FLAG_BORROWED)) return;
+    size_t slots = phot_obj_index_slots(e->len);
+    phot_obj_index *index = (phot_obj_index *)phot_mem_alloc(phot_obj_index_size(slots));
+    assert(index != NULL);
+    phot_obj_index_fill(index, slots, e->obj, e->len);
+    *phot_obj_index_of(e) = index;
+}
+
+// 返回可用的索引；索引只在解析和修改对象时建立和维护，查找只读，多个线程可以同时查找同一棵树
+// 成员数低于阈值时顺序查找，不必访问头部
+static inline phot_obj_index *phot_obj_get_index(const phot_elem *e)
+{
+    return e->len < PHOT_OBJ_INDEX_THRESHOLD ? NULL : *phot_obj_index_of(e);
+}
+
+// 登记刚追加在末尾的成员，成员数达到阈值或超出负载因子时重建
+static void phot_obj_index_append(phot_elem *e)
+{
+    phot_obj_index *index = *phot_obj_index_of(e);
+    if (index == NULL || e->len * 2 > index->mask + 1) {
+        phot_obj_index_drop(e);
+        phot_obj_index_build(e);
+    } else {
+        phot_obj_index_add(index, e->obj, e->len - 1);
+    }
+}
+
+// 在文档的 arena 中为 count 个元素分配数组缓冲区
+static phot_elem *phot_doc_alloc_arr(phot_doc *doc, size_t count)
+{
+    phot_arr_head *head =
+        (phot_arr_head *)phot_doc_alloc(doc, sizeof(phot_arr_head) + count * sizeof(phot_elem), _Alignof(phot_arr_head));
+    head->cap = phot_len32(count);
+    return (phot_elem *)(head + 1);
+}
+
+// 在文档的 arena 中为 count 个成员分配对象缓冲区
+static phot_member *phot_doc_alloc_obj(phot_doc *doc, size_t count)
+{
+    phot_obj_head *head = (phot_obj_head *)phot_doc_alloc(doc, sizeof(phot_obj_head) + count * sizeof(phot_member),
+                                                          _Alignof(phot_obj_head));
+    head->index = NULL;
+    head->cap = phot_len32(count);
+    return (phot_member *)(head + 1);
+}
+
+// 文档里的对象无法事后在 arena 中建立索引，所以大对象在构建时就建好
+static void phot_doc_obj_index(phot_doc *doc, phot_elem *e)
+{
+    if (e->len < PHOT_OBJ_INDEX_THRESHOLD) return;
+    size_t slots = phot_obj_index_slots(e->len);
+    phot_obj_index *index = (phot_obj_index *)phot_doc_alloc(doc, phot_obj_index_size(slots), _Alignof(phot_obj_index));
+    phot_obj_index_fill(index, slots, e->obj, e->len);
+    *phot_obj_index_of(e) = index;
+}
+
+// 键的驻留表：开放寻址、线性探测，槽里保存键的地址，键之前的 4 个字节是它的长度
+// 键一经发布就不再改变，查询不加锁；插入持锁，重新探测后再发布，表满后不再插入
+struct phot_intern {
+    _Atomic(const char *) *slots;
+    size_t mask;
+    size_t max_keys;
+    size_t count;     // 以下两项只在持锁时修改
+    size_t bytes;
+    phot_doc arena;   // 键的存储
+    atomic_size_t lookups, hits, saved;
+#if PHOT_USE_THREADS
+    pthread_mutex_t lock;
+#endif
+};
+
+static inline uint32_t phot_intern_len(const char *key)
+{
+    uint32_t len;
+    memcpy(&len, key - sizeof(uint32_t), sizeof(uint32_t));
+    return len;
+}
+
+// 返回 key 所在的槽或应插入的空槽
+static _Atomic(const char *) *phot_intern_probe(const phot_intern *t, const char *key, size_t klen, uint64_t hash)
+{
+    for (size_t pos = (size_t)hash & t->mask;; pos = (pos + 1) & t->mask) {
+        const char *k = atomic_load_explicit(&t->slots[pos], memory_order_acquire);
+        if (k == NULL || (phot_intern_len(k) == klen && memcmp(k, key, klen) == 0)) {
+            return &t->slots[pos];
+        }
+    }
+}
+
+// 查找或插入 key，返回共享的副本，表满时返回 NULL
+static const char *phot_intern_lookup(phot_intern *t, const char *key, size_t klen, phot_intern_tally *tally)
+{
+    uint64_t hash = phot_hash_key(key, klen);
+    tally->lookups++;
+    const char *k = atomic_load_explicit(phot_intern_probe(t, key, klen, hash), memory_order_acquire);
+    if (k != NULL) {
+        tally->hits++;
+        tally->saved += klen + 1;
+        return k;
+    }
+#if PHOT_USE_THREADS
+    pthread_mutex_lock(&t->lock);
+#endif
+    // 别的线程可能刚插入了同一个键
+    _Atomic(const char *) *slot = phot_intern_probe(t, key, klen, hash);
+    k = atomic_load_explicit(slot, memory_order_relaxed);
+    if (k == NULL && t->count < t->max_keys && phot_len_fits(klen)) {
+        uint32_t len = phot_len32(klen);
+        char *p = (char *)phot_doc_alloc(&t->arena, sizeof(uint32_t) + klen + 1, _Alignof(uint32_t));
+        memcpy(p, &len, sizeof(uint32_t));
+        p += sizeof(uint32_t);
+        memcpy(p, key, klen);
+        p[klen] = '\0';
+        atomic_store_explicit(slot, p, memory_order_release);
+        t->count++;
+        t->bytes += klen + 1;
+        k = p;
+    } else if (k != NULL) {
+        tally->hits++;
+        tally->saved += klen + 1;
+    }
+#if PHOT_USE_THREADS
+    pthread_mutex_unlock(&t->lock);
+#endif
+    return k;
+}
+
+static void phot_intern_flush(phot_intern *t, phot_intern_tally *tally)
+{
+    atomic_fetch_add_explicit(&t->lookups, tally->lookups, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->hits, tally->hits, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->saved, tally->saved, memory_order_relaxed);
+    tally->lookups = tally->hits = tally->saved = 0;
+}
+
+phot_intern *phot_intern_new(size_t max_keys)
+{
+    phot_intern *t = (phot_intern *)phot_mem_alloc(sizeof(phot_intern));
+    assert(t != NULL);
+    t->max_keys = max_keys > 0 ? max_keys : PHOT_INTERN_MAX_KEYS;
+    // 负载因子不超过一半
+    size_t slots = 2;
+    while (slots < t->max_keys * 2) {
+        slots *= 2;
+    }
+    t->slots = (_Atomic(const char *) *)phot_mem_alloc(slots * sizeof(*t->slots));
+    assert(t->slots != NULL);
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&t->slots[i], NULL);
+    }
+    t->mask = slots - 1;
+    t->count = t->bytes = 0;
+    phot_doc_init(&t->arena);
+    atomic_init(&t->lookups, 0);
+    atomic_init(&t->hits, 0);
+    atomic_init(&t->saved, 0);
+#if PHOT_USE_THREADS
+    pthread_mutex_init(&t->lock, NULL);
+#endif
+    return t;
+}
+
+void phot_intern_free(phot_intern *t)
+{
+    if (t == NULL) return;
+#if PHOT_USE_THREADS
+    pthread_mutex_destroy(&t->lock);
+#endif
+    phot_doc_free(&t->arena);
+    phot_mem_free((void *)t->slots, (t->mask + 1) * sizeof(*t->slots));
+    phot_mem_free(t, sizeof(phot_intern));
+}
+
+const char *phot_intern_key(phot_intern *t, const char *key, size_t klen)
+{
+    assert(t != NULL && key != NULL);
+    phot_intern_tally tally = {0, 0, 0};
+    const char *k = phot_intern_lookup(t, key, klen, &tally);
+    phot_intern_flush(t, &tally);
+    return k;
+}
+
+void phot_intern_get_stats(phot_intern *t, phot_intern_stats *stats)
+{
+    assert(t != NULL && stats != NULL);
+#if PHOT_USE_THREADS
+    pthread_mutex_lock(&t->lock);
+#endif
+    stats->keys = t->count;
+    stats->bytes = t->bytes;
+#if PHOT_USE_THREADS
+    pthread_mutex_unlock(&t->lock);
+#endif
+    stats->lookups = atomic_load_explicit(&t->lookups, memory_order_relaxed);
+    stats->hits = atomic_load_explicit(&t->hits, memory_order_relaxed);
+    stats->saved = atomic_load_explicit(&t->saved, memory_order_relaxed);
+}
+
+// 放不进元素的长键从驻留表取共享的只读副本，表满时照常保存
+static void phot_context_set_key(phot_context *c, phot_elem *e, char *str, size_t len)
+{
+    if (c->keys != NULL && len > PHOT_SSO_MAX) {
+        const char *k = phot_intern_lookup(c->keys, str, len, &c->tally);
+        if (k != NULL) {
+            phot_str_borrow(e, k, len);
+            return;
+        }
+    }
+    phot_context_set_str(c, e, str, len);
+}
+
+// 解析结束时把查询计数累加到驻留表上
+static inline void phot_context_flush_keys(phot_context *c)
+{
+    if (c->keys != NULL) {
+        phot_intern_flush(c->keys, &c->tally);
+    }
+}
+
+// 语法只在这里实现一次：用显式栈识别 JSON 并向处理器发出事件，本身不为值分配内存
+// 回调为 NULL 时忽略该事件，回调返回 false 时立即中止解析
+
+#define SAX_EVENT(c, event, ...)                                                         \
+    do {                                                                                 \
+        if ((c)->handler->event != NULL && !(c)->handler->event((c)->ud, __VA_ARGS__)) { \
+            return PHOT_PARSE_ABORTED;                                                   \
+        }                                                                                \
+    } while (0)
+
+#define SAX_EVENT0(c, event)                                               \
+    do {                                                                   \
+        if ((c)->handler->event != NULL && !(c)->handler->event((c)->ud)) { \
+            return PHOT_PARSE_ABORTED;                                     \
+        }                                                                  \
+    } while (0)
+
+// 非递归地解析一个值：当前容器的个数和种类放在局部变量中，进入子容器时把它们压到 level 栈上，
+// 值结束后按当前容器决定期待 ',' 还是右括号；嵌套再深也不会耗尽 C 栈，深度只受 phot_max_depth 限制
+static int phot_sax_nested(phot_context *c, phot_levels *l)
+{
+    size_t depth = 0;     // 未闭合的容器数
+    size_t count = 0;     // 当前容器已解析的个数
+    bool is_obj = false;  // 当前容器是否为对象
+    phot_elem e;
+    char *str;
+    size_t len;
+    int ret;
+    char ch;
+value:
+    if (c->json == c->end) return PHOT_PARSE_EXPECT_VALUE;
+    switch (ch = *c->json) {
+        case '"':
+            if ((ret = phot_parse_str_raw(c, &str, &len)) != PHOT_PARSE_OK) return ret;
+            PHOT_STAT(values[PHOT_STR]++);
+            SAX_EVENT(c, str, str, len);
+            goto next;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '-':
+            if ((ret = phot_parse_num(c, &e)) != PHOT_PARSE_OK) return ret;
+            PHOT_STAT(values[PHOT_NUM]++);
+            SAX_EVENT(c, num, e.num);
+            goto next;
+        case 't':
+        case 'f':
+            if ((ret = phot_parse_bool(c, &e)) != PHOT_PARSE_OK) return ret;
+            PHOT_STAT(values[PHOT_BOOL]++);
+            SAX_EVENT(c, boolean, e.boolean);
+            goto next;
+        case 'n':
+            if ((ret = phot_parse_null(c, &e)) != PHOT_PARSE_OK) return ret;
+            PHOT_STAT(values[PHOT_NULL]++);
+            SAX_EVENT0(c, null);
+            goto next;
+        case '[':
+        case '{':
+            break;
+        default:
+            return PHOT_PARSE_INVALID_VALUE;
+    }
+    if (depth == phot_max_depth) return PHOT_PARSE_TOO_DEEP;
+    c->json++;
+    if (UNLIKELY(depth == l->cap)) {
+        l->level = (size_t *)phot_grow_local(phot_context_allocator(c), l->level, l->local, &l->cap, sizeof(size_t));
+    }
+    l->level[depth++] = count << 1 | is_obj;
+    count = 0;
+    is_obj = ch == '{';
+    PHOT_STAT(values[is_obj ? PHOT_OBJ : PHOT_ARR]++);
+    PHOT_STAT_ENTER();
+    if (is_obj) {
+        SAX_EVENT0(c, start_obj);
+    } else {
+        SAX_EVENT0(c, start_arr);
+    }
+    phot_parse_whitespace(c);
+    if (phot_peek(c) == (is_obj ? '}' : ']')) goto close;
+    if (is_obj) goto key;
+    goto value;
+next:
+    // 一个值结束，接下来是 ',' 或当前容器的右括号
+    if (depth == 0) return PHOT_PARSE_OK;
+    count++;
+    phot_parse_whitespace(c);
+    ch = phot_peek(c);
+    if (ch == ',') {
+        c->json++;
+        phot_parse_whitespace(c);
+        if (is_obj) goto key;
+        goto value;
+    }
+    if (is_obj && ch != '}') return PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+    if (!is_obj && ch != ']') return PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+close:
+    if (UNLIKELY(!phot_len_fits(count))) return PHOT_PARSE_TOO_LONG;
+    c->json++;
+    PHOT_STAT_LEAVE();
+    if (is_obj) {
+        SAX_EVENT(c, end_obj, count);
+    } else {
+        SAX_EVENT(c, end_arr, count);
+    }
+    count = l->level[--depth];
+    is_obj = count & 1;
+    count >>= 1;
+    goto next;
+key:
+    if (phot_peek(c) != '"') return PHOT_PARSE_MISS_KEY;
+    if ((ret = phot_parse_str_raw(c, &str, &len)) != PHOT_PARSE_OK) return ret;
+    PHOT_STAT(keys++);
+    SAX_EVENT(c, key, str, len);
+    phot_parse_whitespace(c);
+    if (phot_peek(c) != ':') return PHOT_PARSE_MISS_COLON;
+    c->json++;
+    phot_parse_whitespace(c);
+    goto value;
+}
+
+static int phot_sax_value(phot_context *c)
+{
+    phot_levels l;
+    l.level = l.local;
+    l.cap = PHOT_WALK_LOCAL_DEPTH;
+    int ret = phot_sax_nested(c, &l);
+    if (l.level != l.local) {
+        phot_mem_free_with(phot_context_allocator(c), l.level, l.cap * sizeof(size_t));
+    }
+    return ret;
+}
+
+static int phot_sax_text(phot_context *c)
+{
+    int ret;
+    phot_parse_whitespace(c);
+    if ((ret = phot_sax_value(c)) == PHOT_PARSE_OK) {
+        phot_parse_whitespace(c);
+        if (c->json != c->end) {
+            ret = PHOT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    return ret;
+}
+
+#if PHOT_USE_INDEX_BACKEND
+static int phot_sax_indexed(phot_context *c)
+{
+    phot_index ix;
+    ix.next = c->json;
+    ix.count = ix.cur = 0;
+    ix.escaped = ix.in_str = 0;
+    ix.boundary = 1;  // 输入的开头视为紧跟在空白之后
+    c->index = &ix;
+    int ret = phot_sax_text(c);
+    c->index = NULL;
+    return ret;
+}
+#endif
+
+// 原地解析会在字符串内写入解码结果，而第一阶段可能还没分类到那里，所以原地解析总是逐字节识别结构
+static int phot_sax_run(phot_context *c)
+{
+#if PHOT_USE_INDEX_BACKEND
+    if (phot_backend_kind == PHOT_BACKEND_INDEX && !c->insitu) return phot_sax_indexed(c);
+#endif
+    return phot_sax_text(c);
+}
+
+// 各种一次性解析的入口，统计打开时记录这一次解析
+static int phot_sax_root(phot_context *c)
+{
+#if PHOT_USE_STATS
+    phot_stats_state st, *outer = phot_stats_cur;
+    memset(&st, 0, sizeof(st));
+    const char *start = c->json;
+    double begin = phot_stats_now();
+    phot_stats_cur = &st;
+    int ret = phot_sax_run(c);
+    phot_stats_cur = outer;
+    st.s.bytes = (size_t)(c->json - start);
+    st.s.stack_peak = c->size;
+    st.s.parse_seconds = phot_stats_now() - begin - st.s.index_seconds;
+    phot_stats_last = st.s;
+    return ret;
+#else
+    return phot_sax_run(c);
+#endif
+}
+
+int phot_parse_sax(const char *json, const phot_handler *handler, void *ud)
+{
+    assert(json != NULL && handler != NULL);
+    phot_context c;
+    c.json = json;
+    c.end = json + strlen(json);
+    c.stack = NULL;
+    c.size = c.top = 0;
+    c.doc = NULL;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = NULL;
+    c.handler = handler;
+    c.ud = ud;
+    int ret = phot_sax_root(&c);
+    phot_mem_free(c.stack, c.size);
+    return ret;
+}
+
+// DOM 构建器也是一个处理器：每个值作为 phot_elem 压入 context 栈，键也作为字符串元素压栈，
+// 数组或对象结束时按事件给出的个数把栈顶的元素出栈，组装成一个新元素再压回去
+
+static inline phot_elem *phot_dom_push(phot_context *c)
+{
+    phot_elem *e = (phot_elem *)phot_context_push(c, sizeof(phot_elem));
+    e->flags = 0;
+    return e;
+}
+
+static bool phot_dom_null(void *ud)
+{
+    phot_dom_push((phot_context *)ud)->type = PHOT_NULL;
+    return true;
+}
+
+static bool phot_dom_bool(void *ud, bool boolean)
+{
+    phot_elem *e = phot_dom_push((phot_context *)ud);
+    e->boolean = boolean;
+    e->type = PHOT_BOOL;
+    return true;
+}
+
+static bool phot_dom_num(void *ud, double num)
+{
+    phot_elem *e = phot_dom_push((phot_context *)ud);
+    e->num = num;
+    e->type = PHOT_NUM;
+    return true;
+}
+
+// str 位于已出栈的区域，必须在压入新元素之前保存
+static bool phot_dom_str(void *ud, const char *str, size_t len)
+{
+    phot_context *c = (phot_context *)ud;
+    phot_elem e;
+    phot_context_set_str(c, &e, (char *)str, len);
+    memcpy(phot_dom_push(c), &e, sizeof(phot_elem));
+    return true;
+}
+
+static bool phot_dom_key(void *ud, const char *key, size_t klen)
+{
+    phot_context *c = (phot_context *)ud;
+    phot_elem e;
+    phot_context_set_key(c, &e, (char *)key, klen);
+    memcpy(phot_dom_push(c), &e, sizeof(phot_elem));
+    return true;
+}
+
+static bool phot_dom_end_arr(void *ud, size_t count)
+{
+    phot_context *c = (phot_context *)ud;
+    phot_elem e;
+    if (c->doc != NULL) {
+        e.arr = phot_doc_alloc_arr(c->doc, count);
+        e.type = PHOT_ARR;
+        e.flags = PHOT_FLAG_BORROWED;
+    } else {
+        // 解析器已经保证 count 不超过 UINT32_MAX
+        e.arr = count > 0 ? phot_arr_realloc(NULL, count) : NULL;
+        e.type = PHOT_ARR;
+        e.flags = 0;
+    }
+    if (count > 0) {
+        memcpy(e.arr, phot_context_pop(c, count * sizeof(phot_elem)), count * sizeof(phot_elem));
+    }
+    e.len = phot_len32(count);
+    memcpy(phot_dom_push(c), &e, sizeof(phot_elem));
+    return true;
+}
+
+static bool phot_dom_end_obj(void *ud, size_t count)
+{
+    phot_context *c = (phot_context *)ud;
+    phot_elem e;
+    if (c->doc != NULL) {
+        e.obj = phot_doc_alloc_obj(c->doc, count);
+        e.type = PHOT_OBJ;
+        e.flags = PHOT_FLAG_BORROWED;
+    } else {
+        // 解析器已经保证 count 不超过 UINT32_MAX
+        e.obj = count > 0 ? phot_obj_realloc(NULL, count) : NULL;
+        e.type = PHOT_OBJ;
+        e.flags = 0;
+    }
+    // 栈上键与值交替排列，正好就是成员的布局
+    if (count > 0) {
+        memcpy(e.obj, phot_context_pop(c, count * sizeof(phot_member)), count * sizeof(phot_member));
+    }
+    e.len = phot_len32(count);
+    if (c->doc != NULL) {
+        phot_doc_obj_index(c->doc, &e);
+    } else {
+        phot_obj_index_build(&e);
+    }
+    memcpy(phot_dom_push(c), &e, sizeof(phot_elem));
+    return true;
+}
+
+static const phot_handler phot_dom_handler = {
+    .null = phot_dom_null,
+    .boolean = phot_dom_bool,
+    .num = phot_dom_num,
+    .str = phot_dom_str,
+    .start_arr = NULL,
+    .end_arr = phot_dom_end_arr,
+    .start_obj = NULL,
+    .key = phot_dom_key,
+    .end_obj = phot_dom_end_obj,
+};
+
+static int phot_parse_root(phot_context *c, phot_elem *e)
+{
+    c->handler = &phot_dom_handler;
+    c->ud = c;
+    phot_init(e);
+    int ret = phot_sax_root(c);
+    if (ret == PHOT_PARSE_OK) {
+        memcpy(e, phot_context_pop(c, sizeof(phot_elem)), sizeof(phot_elem));
+    } else if (ret == PHOT_PARSE_ROOT_NOT_SINGULAR) {
+        phot_free((phot_elem *)phot_context_pop(c, sizeof(phot_elem)));
+    } else {
+        // 出错时栈上只剩下已经构建好的元素（包括键），逐个释放
+        while (c->top > 0) {
+            phot_free((phot_elem *)phot_context_pop(c, sizeof(phot_elem)));
+        }
+    }
+    assert(c->top == 0);
+    return ret;
+}
+
+int phot_parse(phot_elem *e, const char *json)
+{
+    assert(json != NULL);
+    return phot_parse_n(e, json, strlen(json));
+}
+
+int phot_parse_n(phot_elem *e, const char *json, size_t len) { return phot_parse_intern(e, json, len, NULL); }
+
+// 缩回可复用的缓冲区，trim 为 0 时不缩
+static void phot_scratch_trim(char **buf, size_t *size, size_t trim)
+{
+    if (trim != 0 && *size > trim) {
+        *buf = (char *)phot_mem_realloc(*buf, *size, trim);
+        assert(*buf != NULL);
+        *size = trim;
+    }
+}
+
+void phot_parser_init(phot_parser *p)
+{
+    assert(p != NULL);
+    p->stack = NULL;
+    p->size = 0;
+    p->trim = 0;
+    p->keys = NULL;
+}
+
+int phot_parse_with(phot_parser *p, phot_elem *e, const char *json, size_t len)
+{
+    assert(p != NULL && e != NULL && json != NULL);
+    phot_context c;
+    c.json = json;
+    c.end = json + len;
+    c.stack = p->stack;
+    c.size = p->size;
+    c.top = 0;
+    c.doc = NULL;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = p->keys;
+    c.tally = (phot_intern_tally){0, 0, 0};
+    int ret = phot_parse_root(&c, e);
+    phot_context_flush_keys(&c);
+    p->stack = c.stack;
+    p->size = c.size;
+    phot_scratch_trim(&p->stack, &p->size, p->trim);
+    return ret;
+}
+
+void phot_parser_free(phot_parser *p)
+{
+    assert(p != NULL);
+    phot_mem_free(p->stack, p->size);
+    p->stack = NULL;
+    p->size = 0;
+}
+
+int phot_parse_intern(phot_elem *e, const char *json, size_t len, phot_intern *keys)
+{
+    phot_parser p;
+    phot_parser_init(&p);
+    p.keys = keys;
+    int ret = phot_parse_with(&p, e, json, len);
+    phot_parser_free(&p);
+    return ret;
+}
+
+int phot_parse_insitu(phot_elem *e, char *json)
+{
+    assert(e != NULL && json != NULL);
+    phot_context c;
+    c.json = json;
+    c.end = json + strlen(json);
+    c.stack = NULL;
+    c.size = c.top = 0;
+    c.doc = NULL;
+    c.insitu = true;
+    c.index = NULL;
+    c.keys = NULL;
+    int ret = phot_parse_root(&c, e);
+    phot_mem_free(c.stack, c.size);
+    return ret;
+}
+
+void phot_doc_init(phot_doc *doc)
+{
+    assert(doc != NULL);
+    phot_init(&doc->root);
+    doc->head = doc->cur = NULL;
+    doc->used = 0;
+    doc->stack = NULL;
+    doc->size = 0;
+    doc->status = PHOT_PARSE_OK;
+    doc->src = doc->end = NULL;
+    doc->keys = NULL;
+    doc->alloc = NULL;
+}
+
+// 解析到文档的 arena 中但不重置文档，一个文档因此可以容纳多个根元素
+static int phot_doc_parse_n(phot_doc *doc, phot_elem *e, const char *json, size_t len)
+{
+    phot_context c;
+    c.json = json;
+    c.end = json + len;
+    c.stack = doc->stack;
+    c.size = doc->size;
+    c.top = 0;
+    c.doc = doc;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = doc->keys;
+    c.tally = (phot_intern_tally){0, 0, 0};
+    int ret = phot_parse_root(&c, e);
+    phot_context_flush_keys(&c);
+    // 解析栈留给下次复用
+    doc->stack = c.stack;
+    doc->size = c.size;
+    return ret;
+}
+
+int phot_parse_doc(phot_doc *doc, const char *json)
+{
+    assert(doc != NULL && json != NULL);
+    phot_doc_reset(doc);
+    return phot_doc_parse_n(doc, &doc->root, json, strlen(json));
+}
+
+void phot_doc_reset(phot_doc *doc)
+{
+    assert(doc != NULL);
+    phot_init(&doc->root);
+    doc->cur = doc->head;
+    doc->used = 0;
+    doc->status = PHOT_PARSE_OK;
+}
+
+void phot_doc_free(phot_doc *doc)
+{
+    assert(doc != NULL);
+    phot_chunk *chunk = doc->head;
+    while (chunk != NULL) {
+        phot_chunk *next = chunk->next;
+        phot_mem_free_with(doc->alloc, chunk, sizeof(phot_chunk) + chunk->size);
+        chunk = next;
+    }
+    phot_mem_free_with(doc->alloc, doc->stack, doc->size);
+    phot_doc_init(doc);
+}
+
+// 惰性文档：元素只记下原文的范围，第一次访问时才就地展开。数组和对象一次只展开一层，
+// 其中的数组和对象由 phot_skip_nest 整个跳过，字符串和数字只找到结尾，true、false 和 null 直接解析
+// 展开出的节点、键和字符串与文档模式一样分配在 arena 中
+
+// 只记下原文的起始位置：展开时的语法检查会停在这个值的结尾，不必另存长度
+static inline void phot_lazy_init(phot_elem *e, phot_type type, const char *raw, phot_doc *doc)
+{
+    e->ldoc = doc;
+    e->len = (uint32_t)(raw - doc->src);
+    e->type = type;
+    e->flags = PHOT_FLAG_LAZY;
+}
+
+// p 指向开引号，返回闭引号之后的位置，转义和控制字符留到解码时检查
+static const char *phot_skip_str(const char *p, const char *end)
+{
+    p++;
+    while (1) {
+        p = phot_scan_str(p, end);
+        if (p == end) return NULL;
+        if (*p == '"') return p + 1;
+        if (*p != '\\') {
+            p++;
+        } else if (end - p >= 2) {
+            p += 2;
+        } else {
+            return NULL;
+        }
+    }
+}
+
+static int phot_lazy_value(phot_context *c, phot_elem *e)
+{
+    const char *p = c->json, *q;
+    phot_type type;
+    if (p == c->end) return PHOT_PARSE_EXPECT_VALUE;
+    switch (*p) {
+        case '"':
+            if ((q = phot_skip_str(p, c->end)) == NULL) return PHOT_PARSE_MISS_QUOTATION_MARK;
+            type = PHOT_STR;
+            break;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '-':
+            for (q = p + 1; q != c->end && is_num_char(*q); q++) {
+            }
+            type = PHOT_NUM;
+            break;
+        case '[':
+            if ((q = phot_skip_nest(p, c->end)) == NULL) return PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            type = PHOT_ARR;
+            break;
+        case '{':
+            if ((q = phot_skip_nest(p, c->end)) == NULL) return PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            type = PHOT_OBJ;
+            break;
+        case 't':
+        case 'f':
+            e->flags = 0;
+            return phot_parse_bool(c, e);
+        case 'n':
+            e->flags = 0;
+            return phot_parse_null(c, e);
+        default:
+            return PHOT_PARSE_INVALID_VALUE;
+    }
+    phot_lazy_init(e, type, p, c->doc);
+    c->json = q;
+    return PHOT_PARSE_OK;
+}
+
+// 展开一层数组，子元素先压栈，个数确定后再搬到 arena 中
+static int phot_lazy_arr(phot_context *c, phot_elem *e)
+{
+    expect(c, '[');
+    phot_parse_whitespace(c);
+    size_t count = 0;
+    if (phot_peek(c) != ']') {
+        while (1) {
+            int ret = phot_lazy_value(c, (phot_elem *)phot_context_push(c, sizeof(phot_elem)));
+            if (ret != PHOT_PARSE_OK) return ret;
+            count++;
+            phot_parse_whitespace(c);
+            char ch = phot_peek(c);
+            if (ch == ',') {
+                c->json++;
+                phot_parse_whitespace(c);
+            } else if (ch == ']') {
+                break;
+            } else {
+                return PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+        }
+    }
+    c->json++;
+    e->arr = phot_doc_alloc_arr(c->doc, count);
+    if (count > 0) {
+        memcpy(e->arr, phot_context_pop(c, count * sizeof(phot_elem)), count * sizeof(phot_elem));
+    }
+    e->len = phot_len32(count);
+    return PHOT_PARSE_OK;
+}
+
+// 展开一层对象，键在这里就解码，值保持惰性
+static int phot_lazy_obj(phot_context *c, phot_elem *e)
+{
+    expect(c, '{');
+    phot_parse_whitespace(c);
+    size_t count = 0;
+    if (phot_peek(c) != '}') {
+        while (1) {
+            char *str;
+            size_t klen;
+            phot_elem key;
+            int ret;
+            if (phot_peek(c) != '"') return PHOT_PARSE_MISS_KEY;
+            if ((ret = phot_parse_str_raw(c, &str, &klen)) != PHOT_PARSE_OK) return ret;
+            // 键可能位于已出栈的区域，必须在压入成员之前保存
+            phot_context_set_key(c, &key, str, klen);
+            phot_parse_whitespace(c);
+            if (phot_peek(c) != ':') return PHOT_PARSE_MISS_COLON;
+            c->json++;
+            phot_parse_whitespace(c);
+            phot_member *m = (phot_member *)phot_context_push(c, sizeof(phot_member));
+            memcpy(&m->key, &key, sizeof(phot_elem));
+            if ((ret = phot_lazy_value(c, &m->value)) != PHOT_PARSE_OK) return ret;
+            count++;
+            phot_parse_whitespace(c);
+            char ch = phot_peek(c);
+            if (ch == ',') {
+                c->json++;
+                phot_parse_whitespace(c);
+            } else if (ch == '}') {
+                break;
+            } else {
+                return PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            }
+        }
+    }
+    c->json++;
+    e->obj = phot_doc_alloc_obj(c->doc, count);
+    if (count > 0) {
+        memcpy(e->obj, phot_context_pop(c, count * sizeof(phot_member)), count * sizeof(phot_member));
+    }
+    e->len = phot_len32(count);
+    phot_doc_obj_index(c->doc, e);
+    return PHOT_PARSE_OK;
+}
+
+// 就地解码惰性元素，出错时记下文档的第一个错误，元素变为同类型的零值并带上 PHOT_FLAG_INVALID，
+// 错误码记在没有用到的 sso_tail 中，由 phot_get_status 取出
+static void phot_lazy_expand(phot_elem *e)
+{
+    phot_doc *doc = e->ldoc;
+    phot_context c;
+    c.json = doc->src + e->len;
+    c.end = doc->end;
+    c.stack = doc->stack;
+    c.size = doc->size;
+    c.top = 0;
+    c.doc = doc;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = doc->keys;
+    c.tally = (phot_intern_tally){0, 0, 0};
+    c.handler = NULL;
+    c.ud = NULL;
+    phot_elem num;
+    char *str;
+    size_t len;
+    int ret;
+    switch (e->type) {
+        case PHOT_NUM:
+            ret = phot_parse_num(&c, &num);
+            if (ret == PHOT_PARSE_OK && is_num_char(phot_peek(&c))) {
+                ret = PHOT_PARSE_INVALID_VALUE;
+            }
+            e->num = ret == PHOT_PARSE_OK ? num.num : 0.0;
+            e->flags = 0;
+            break;
+        case PHOT_STR:
+            // 出错时借用空字符串而不放在元素内，以免覆盖 sso_tail
+            if ((ret = phot_parse_str_raw(&c, &str, &len)) != PHOT_PARSE_OK) {
+                phot_str_borrow(e, "", 0);
+            } else {
+                phot_context_set_str(&c, e, str, len);
+            }
+            break;
+        case PHOT_ARR:
+            if ((ret = phot_lazy_arr(&c, e)) != PHOT_PARSE_OK) {
+                e->arr = NULL;
+                e->len = 0;
+            }
+            e->flags = PHOT_FLAG_BORROWED;
+            break;
+        case PHOT_OBJ:
+            if ((ret = phot_lazy_obj(&c, e)) != PHOT_PARSE_OK) {
+                e->obj = NULL;
+                e->len = 0;
+            }
+            e->flags = PHOT_FLAG_BORROWED;
+            break;
+        default:
+            assert(0 && "invalid lazy type");
+            return;
+    }
+    phot_context_flush_keys(&c);
+    doc->stack = c.stack;
+    doc->size = c.size;
+    if (ret != PHOT_PARSE_OK) {
+        e->flags |= PHOT_FLAG_INVALID;
+        e->sso_tail = (char)ret;
+        if (doc->status == PHOT_PARSE_OK) {
+            doc->status = ret;
+        }
+    }
+}
+
+// 惰性元素在第一次访问时就地展开，所以只读的函数也会经由 const 指针修改它
+static inline void phot_lazy_load(const phot_elem *e)
+{
+    if (UNLIKELY(e->flags & PHOT_FLAG_LAZY)) {
+        phot_lazy_expand((phot_elem *)e);
+    }
+}
+
+int phot_parse_lazy(phot_doc *doc, const char *json, size_t len)
+{
+    assert(doc != NULL && json != NULL);
+    phot_doc_reset(doc);
+    const char *end = json + len;
+    const char *p = phot_skip_ws(json, end), *q = NULL;
+    doc->src = json;
+    doc->end = end;
+    // 惰性元素以 32 位偏移记录原文的位置
+    if (p != end && (*p == '[' || *p == '{') && len <= UINT32_MAX) {
+        q = phot_skip_nest(p, end);
+        if (q != NULL && phot_skip_ws(q, end) != end) {
+            q = NULL;
+        }
+    }
+    // 根为标量时直接解析；括号不配对时也交给完整的解析，返回的错误因此与 phot_parse_doc 相同
+    if (q == NULL) return phot_doc_parse_n(doc, &doc->root, json, len);
+    phot_lazy_init(&doc->root, *p == '[' ? PHOT_ARR : PHOT_OBJ, p, doc);
+    return PHOT_PARSE_OK;
+}
+
+// 增量解析：token 之间由显式的状态机推进，未闭合的容器记录在 nest 栈上，所以可以在任意位置暂停
+// 完整落在输入块内的 token 直接交给与 phot_parse 相同的解码函数，跨块的 token 先拼接到 token 缓冲区
+
+enum {
+    STREAM_VALUE,      // 期待一个值
+    STREAM_ARR_FIRST,  // '[' 之后，期待值或 ']'
+    STREAM_OBJ_FIRST,  // '{' 之后，期待键或 '}'
+    STREAM_KEY,        // 对象中 ',' 之后，期待键
+    STREAM_COLON,      // 键之后，期待 ':'
+    STREAM_AFTER,      // 值之后，期待 ','、右括号或输入结束
+    STREAM_STR,        // 以下为跨块的 token：字符串值
+    STREAM_KEY_STR,    // 键
+    STREAM_NUM,        // 数字
+    STREAM_LIT,        // true、false 或 null
+};
+
+static void phot_stream_context(phot_stream *s, phot_context *c)
+{
+    c->json = c->end = NULL;
+    c->stack = s->stack;
+    c->size = s->size;
+    c->top = s->top;
+    c->doc = NULL;
+    c->insitu = false;
+    c->index = NULL;
+    c->keys = NULL;
+    c->handler = s->handler;
+    c->ud = s->root != NULL ? c : s->ud;  // DOM 构建器的用户数据就是 context 本身
+}
+
+static void phot_stream_save(phot_stream *s, const phot_context *c)
+{
+    s->stack = c->stack;
+    s->size = c->size;
+    s->top = c->top;
+}
+
+// 追加到 token 缓冲区，始终为结尾的 '\0' 留出空间
+static void phot_stream_append(phot_stream *s, const char *p, size_t n)
+{
+    if (s->tlen + n >= s->tcap) {
+        size_t old_cap = s->tcap;
+        if (s->tcap == 0) {
+            s->tcap = PHOT_PARSE_STACK_INIT_SIZE;
+        }
+        while (s->tlen + n >= s->tcap) {
+            s->tcap += s->tcap >> 1;
+        }
+        s->token = (char *)phot_mem_realloc(s->token, old_cap, s->tcap);
+    }
+    memcpy(s->token + s->tlen, p, n);
+    s->tlen += n;
+}
+
+// 在 [p, end) 中查找未被转义的引号，bs 为 p 之前紧邻的反斜杠个数
+static const char *phot_stream_find_quote(const char *p, const char *end, size_t bs)
+{
+    const char *const start = p;
+    while ((p = (const char *)memchr(p, '"', end - p)) != NULL) {
+        const char *q = p;
+        while (q > start && q[-1] == '\\') {
+            q--;
+        }
+        if (((size_t)(p - q) + (q == start ? bs : 0)) % 2 == 0) return p;
+        p++;
+    }
+    return NULL;
+}
+
+static inline void phot_stream_value_done(phot_stream *s)
+{
+    if (s->depth > 0) {
+        s->nest[s->depth - 1] += 2;
+    }
+    s->state = STREAM_AFTER;
+}
+
+static int phot_stream_open(phot_stream *s, phot_context *c, bool is_obj)
+{
+    if (s->depth == phot_max_depth) return PHOT_PARSE_TOO_DEEP;
+    if (s->depth == s->ncap) {
+        size_t old_cap = s->ncap;
+        s->ncap = s->ncap == 0 ? 16 : s->ncap * 2;
+        s->nest = (size_t *)phot_mem_realloc(s->nest, old_cap * sizeof(size_t), s->ncap * sizeof(size_t));
+    }
+    s->nest[s->depth++] = is_obj;
+    if (is_obj) {
+        SAX_EVENT0(c, start_obj);
+        s->state = STREAM_OBJ_FIRST;
+    } else {
+        SAX_EVENT0(c, start_arr);
+        s->state = STREAM_ARR_FIRST;
+    }
+    return PHOT_PARSE_OK;
+}
+
+static int phot_stream_close(phot_stream *s, phot_context *c)
+{
+    size_t top = s->nest[--s->depth];
+    if (UNLIKELY(!phot_len_fits(top >> 1))) return PHOT_PARSE_TOO_LONG;
+    if (top & 1) {
+        SAX_EVENT(c, end_obj, top >> 1);
+    } else {
+        SAX_EVENT(c, end_arr, top >> 1);
+    }
+    phot_stream_value_done(s);
+    return PHOT_PARSE_OK;
+}
+
+// 解码从 c->json 开始的一个完整 token 并发出事件
+static int phot_stream_token(phot_stream *s, phot_context *c, int state)
+{
+    phot_elem e;
+    char *str;
+    size_t len;
+    int ret;
+    switch (state) {
+        case STREAM_STR:
+        case STREAM_KEY_STR:
+            if ((ret = phot_parse_str_raw(c, &str, &len)) != PHOT_PARSE_OK) return ret;
+            if (state == STREAM_KEY_STR) {
+                SAX_EVENT(c, key, str, len);
+                s->state = STREAM_COLON;
                 return PHOT_PARSE_OK;
-            case '\\':
-                switch (*p++) {
-                    case '"':
-                        phot_push_ch(c, '"');
-                        break;
-                    case '\\':
-                        phot_push_ch(c, '\\');
-                        break;
-                    case '/':
-                        phot_push_ch(c, '/');
+            }
+            SAX_EVENT(c, str, str, len);
+            break;
+        case STREAM_NUM:
+            if ((ret = phot_parse_num(c, &e)) != PHOT_PARSE_OK) return ret;
+            SAX_EVENT(c, num, e.num);
+            break;
+        default:
+            if (*c->json == 'n') {
+                if ((ret = phot_parse_null(c, &e)) != PHOT_PARSE_OK) return ret;
+                SAX_EVENT0(c, null);
+            } else {
+                if ((ret = phot_parse_bool(c, &e)) != PHOT_PARSE_OK) return ret;
+                SAX_EVENT(c, boolean, e.boolean);
+            }
+    }
+    phot_stream_value_done(s);
+    return PHOT_PARSE_OK;
+}
+
+static int phot_stream_run(phot_stream *s, phot_context *c, const char *p, const char *end);
+
+// 解码 token 缓冲区中拼接完整（或输入已结束）的 token
+static int phot_stream_flush(phot_stream *s, phot_context *c)
+{
+    const char *end = s->token + s->tlen;
+    s->token[s->tlen] = '\0';
+    s->tlen = 0;
+    c->json = s->token;
+    c->end = end;
+    int ret = phot_stream_token(s, c, s->state);
+    // 数字后面紧跟的 "+-.eE" 等字符没有被解码函数吃掉，它们在值之后一定是错误
+    if (ret == PHOT_PARSE_OK && c->json < end) {
+        ret = phot_stream_run(s, c, c->json, end);
+    }
+    return ret;
+}
+
+// 开始一个 token，完整落在 [*pp, end) 内时直接解码，否则存入 token 缓冲区
+static int phot_stream_begin(phot_stream *s, phot_context *c, int state, const char **pp, const char *end)
+{
+    const char *p = *pp;
+    bool complete;
+    switch (state) {
+        case STREAM_STR:
+        case STREAM_KEY_STR:
+            complete = phot_stream_find_quote(p + 1, end, 0) != NULL;
+            break;
+        case STREAM_NUM: {
+            const char *q = p;
+            while (q < end && is_num_char(*q)) {
+                q++;
+            }
+            complete = q < end;
+            break;
+        }
+        default:
+            complete = end - p >= (*p == 'f' ? 5 : 4);
+    }
+    if (!complete) {
+        phot_stream_append(s, p, end - p);
+        s->state = state;
+        *pp = end;
+        return PHOT_PARSE_OK;
+    }
+    c->json = p;
+    c->end = end;
+    int ret = phot_stream_token(s, c, state);
+    *pp = c->json;
+    return ret;
+}
+
+static int phot_stream_run(phot_stream *s, phot_context *c, const char *p, const char *end)
+{
+    int ret = PHOT_PARSE_OK;
+    while (p < end && ret == PHOT_PARSE_OK) {
+        char ch = *p;
+        switch (s->state) {
+            case STREAM_STR:
+            case STREAM_KEY_STR: {
+                size_t bs = 0;
+                while (s->token[s->tlen - 1 - bs] == '\\') {
+                    bs++;
+                }
+                const char *q = phot_stream_find_quote(p, end, bs);
+                if (q == NULL) {
+                    phot_stream_append(s, p, end - p);
+                    return PHOT_PARSE_OK;
+                }
+                phot_stream_append(s, p, q + 1 - p);
+                p = q + 1;
+                ret = phot_stream_flush(s, c);
+                continue;
+            }
+            case STREAM_NUM: {
+                const char *q = p;
+                while (q < end && is_num_char(*q)) {
+                    q++;
+                }
+                phot_stream_append(s, p, q - p);
+                if (q == end) return PHOT_PARSE_OK;
+                p = q;
+                ret = phot_stream_flush(s, c);
+                continue;
+            }
+            case STREAM_LIT: {
+                size_t need = (s->token[0] == 'f' ? 5 : 4) - s->tlen;
+                size_t n = (size_t)(end - p) < need ? (size_t)(end - p) : need;
+                phot_stream_append(s, p, n);
+                if (n < need) return PHOT_PARSE_OK;
+                p += n;
+                ret = phot_stream_flush(s, c);
+                continue;
+            }
+            default:
+                break;
+        }
+        if (is_ws(ch)) {
+            p++;
+            continue;
+        }
+        switch (s->state) {
+            case STREAM_ARR_FIRST:
+                if (ch == ']') {
+                    p++;
+                    ret = phot_stream_close(s, c);
+                    break;
+                }
+                // fall through
+            case STREAM_VALUE:
+                switch (ch) {
+                    case '[':
+                    case '{':
+                        p++;
+                        ret = phot_stream_open(s, c, ch == '{');
                         break;
-                    case 'b':
-                        phot_push_ch(c, '\b');
+                    case '"':
+                        ret = phot_stream_begin(s, c, STREAM_STR, &p, end);
                         break;
+                    case 't':
                     case 'f':
-                        phot_push_ch(c, '\f');
-                        break;
                     case 'n':
-                        phot_push_ch(c, '\n');
-                        break;
-                    case 'r':
-                        phot_push_ch(c, '\r');
-                        break;
-                    case 't':
-                        phot_push_ch(c, '\t');
-                        break;
-                    case 'u':
-                        if ((p = phot_parse_hex4(p, &u)) == NULL) {
-                            STR_ERROR(PHOT_PARSE_INVALID_UNICODE_HEX);
-                        }
-                        if (u >= 0xD800 && u <= 0xDBFF) {  // 处理代理对
-                            if (*p++ != '\\' || *p++ != 'u') {
-                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_SURROGATE);
-                            }
-                            uint32_t u2;
-                            if ((p = phot_parse_hex4(p, &u2)) == NULL) {
-                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_HEX);
-                            }
-                            if (u2 < 0xDC00 || u2 > 0xDFFF) {
-                                STR_ERROR(PHOT_PARSE_INVALID_UNICODE_SURROGATE);
-                            }
-                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
-                        }
-                        phot_encode_utf8(c, u);
+                        ret = phot_stream_begin(s, c, STREAM_LIT, &p, end);
                         break;
+                    case '\0':
+                        return PHOT_PARSE_EXPECT_VALUE;
                     default:
-                        STR_ERROR(PHOT_PARSE_INVALID_STR_ESCAPE);
+                        if (ch != '-' && !is_digit(ch)) return PHOT_PARSE_INVALID_VALUE;
+                        ret = phot_stream_begin(s, c, STREAM_NUM, &p, end);
                 }
                 break;
-            case '\0':
-                STR_ERROR(PHOT_PARSE_MISS_QUOTATION_MARK);
-            default:
-                if ((unsigned char)ch < 0x20) {
-                    STR_ERROR(PHOT_PARSE_INVALID_STR_CHAR);
+            case STREAM_OBJ_FIRST:
+                if (ch == '}') {
+                    p++;
+                    ret = phot_stream_close(s, c);
+                    break;
+                }
+                // fall through
+            case STREAM_KEY:
+                if (ch != '"') return PHOT_PARSE_MISS_KEY;
+                ret = phot_stream_begin(s, c, STREAM_KEY_STR, &p, end);
+                break;
+            case STREAM_COLON:
+                if (ch != ':') return PHOT_PARSE_MISS_COLON;
+                p++;
+                s->state = STREAM_VALUE;
+                break;
+            default:  // STREAM_AFTER
+                if (s->depth == 0) return PHOT_PARSE_ROOT_NOT_SINGULAR;
+                if (s->nest[s->depth - 1] & 1) {
+                    if (ch != ',' && ch != '}') return PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                } else {
+                    if (ch != ',' && ch != ']') return PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
+                p++;
+                if (ch == ',') {
+                    s->state = s->nest[s->depth - 1] & 1 ? STREAM_KEY : STREAM_VALUE;
+                } else {
+                    ret = phot_stream_close(s, c);
                 }
-                phot_push_ch(c, ch);
         }
     }
+    return ret;
 }
 
-static int phot_parse_str(phot_context *c, phot_elem *e)
+static void phot_stream_reset(phot_stream *s)
 {
-    char *str;
-    size_t len;
-    int ret = phot_parse_str_raw(c, &str, &len);
-    if (ret == PHOT_PARSE_OK) {
-        phot_set_str(e, str, len);
-    }
-    return ret;
+    s->stack = NULL;
+    s->size = s->top = 0;
+    s->nest = NULL;
+    s->depth = s->ncap = 0;
+    s->token = NULL;
+    s->tlen = s->tcap = 0;
+    s->state = STREAM_VALUE;
+    s->status = PHOT_PARSE_OK;
+}
+
+void phot_stream_init(phot_stream *s, phot_elem *e)
+{
+    assert(s != NULL && e != NULL);
+    phot_init(e);
+    s->handler = &phot_dom_handler;
+    s->ud = NULL;
+    s->root = e;
+    phot_stream_reset(s);
 }
 
-static int phot_parse_value(phot_context *c, phot_elem *e);
+void phot_stream_init_sax(phot_stream *s, const phot_handler *handler, void *ud)
+{
+    assert(s != NULL && handler != NULL);
+    s->handler = handler;
+    s->ud = ud;
+    s->root = NULL;
+    phot_stream_reset(s);
+}
 
-static int phot_parse_arr(phot_context *c, phot_elem *e)
+int phot_stream_feed(phot_stream *s, const char *buf, size_t len)
 {
-    expect(c, '[');
-    phot_parse_whitespace(c);
-    if (*c->json == ']') {
-        c->json++;
-        phot_set_arr(e, 0);
-        return PHOT_PARSE_OK;
+    assert(s != NULL && (buf != NULL || len == 0));
+    if (s->status == PHOT_PARSE_OK) {
+        phot_context c;
+        phot_stream_context(s, &c);
+        s->status = phot_stream_run(s, &c, buf, buf + len);
+        phot_stream_save(s, &c);
     }
-    int ret;
-    size_t len = 0;
-    while (1) {
-        phot_elem elem;
-        phot_init(&elem);
-        if ((ret = phot_parse_value(c, &elem)) != PHOT_PARSE_OK) {
-            break;
-        }
-        memcpy(phot_context_push(c, sizeof(phot_elem)), &elem, sizeof(phot_elem));
-        len++;
-        phot_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-            phot_parse_whitespace(c);
-        } else if (*c->json == ']') {
-            c->json++;
-            phot_set_arr(e, len);
-            memcpy(e->arr, phot_context_pop(c, len * sizeof(phot_elem)), len * sizeof(phot_elem));
-            e->alen = len;
-            return PHOT_PARSE_OK;
-        } else {
-            ret = PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
+    return s->status;
+}
+
+int phot_stream_finish(phot_stream *s)
+{
+    assert(s != NULL);
+    phot_context c;
+    phot_stream_context(s, &c);
+    int ret = s->status;
+    // 输入结束相当于 phot_parse 读到了结尾的 '\0'
+    if (ret == PHOT_PARSE_OK && s->state >= STREAM_STR) {
+        ret = phot_stream_flush(s, &c);
+    }
+    if (ret == PHOT_PARSE_OK) {
+        switch (s->state) {
+            case STREAM_VALUE:
+            case STREAM_ARR_FIRST:
+                ret = PHOT_PARSE_EXPECT_VALUE;
+                break;
+            case STREAM_OBJ_FIRST:
+            case STREAM_KEY:
+                ret = PHOT_PARSE_MISS_KEY;
+                break;
+            case STREAM_COLON:
+                ret = PHOT_PARSE_MISS_COLON;
+                break;
+            default:
+                if (s->depth > 0) {
+                    ret = s->nest[s->depth - 1] & 1 ? PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+                                                     : PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
         }
     }
-    // 清理 context 上的临时栈
-    for (size_t i = 0; i < len; i++) {
-        phot_free((phot_elem *)phot_context_pop(c, sizeof(phot_elem)));
+    if (s->root != NULL) {
+        if (ret == PHOT_PARSE_OK) {
+            memcpy(s->root, phot_context_pop(&c, sizeof(phot_elem)), sizeof(phot_elem));
+        }
+        while (c.top > 0) {
+            phot_free((phot_elem *)phot_context_pop(&c, sizeof(phot_elem)));
+        }
     }
+    phot_mem_free(c.stack, c.size);
+    phot_mem_free(s->nest, s->ncap * sizeof(size_t));
+    phot_mem_free(s->token, s->tcap);
+    phot_stream_reset(s);
+    s->status = ret;
     return ret;
 }
 
-static int phot_parse_obj(phot_context *c, phot_elem *e)
+// 数字序列化：整数直接按十进制输出，其余的数用 Grisu2 算法生成能够往返的最短有效数字（极少数情况下多一位）
+// 输出版式与 "%.17g" 一致，即首位数字的十进制指数小于 -4 或不小于 17 时使用科学计数法
+
+#define DOUBLE_HIDDEN_BIT 0x0010000000000000ULL
+#define DOUBLE_SIG_MASK 0x000FFFFFFFFFFFFFULL
+
+typedef struct {
+    uint64_t f;
+    int e;
+} phot_diy_fp;  // 表示 f * 2^e
+
+// 10^k 规格化后的 64 位近似值及二进制指数，k 从 -348 到 340，步长为 8
+static const uint64_t phot_cached_pow10_f[] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL,
+};
+
+static const int16_t phot_cached_pow10_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066,
+};
+
+static const uint64_t phot_pow10_u64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL,
+    10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+static const char phot_digit_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 两数相乘并保留高 64 位，按低 64 位四舍五入
+static inline phot_diy_fp phot_diy_fp_mul(phot_diy_fp a, phot_diy_fp b)
+{
+    uint64_t hi, lo = phot_umul128(a.f, b.f, &hi);
+    return (phot_diy_fp){hi + (lo >> 63), a.e + b.e + 64};
+}
+
+static inline phot_diy_fp phot_diy_fp_normalize(phot_diy_fp a)
 {
-    expect(c, '{');
-    phot_parse_whitespace(c);
-    if (*c->json == '}') {
-        c->json++;
-        phot_set_obj(e, 0);
-        return PHOT_PARSE_OK;
+    int shift = __builtin_clzll(a.f);
+    return (phot_diy_fp){a.f << shift, a.e - shift};
+}
+
+// 在安全区间内把末位数字向 w 靠拢
+static void phot_grisu_round(char *buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
     }
-    int ret;
-    size_t len = 0;
-    phot_member m;
-    m.key = NULL;
-    while (1) {
-        char *str;
-        phot_init(&m.value);
-        // 解析成员键
-        if (*c->json != '"') {
-            ret = PHOT_PARSE_MISS_KEY;
-            break;
-        }
-        if ((ret = phot_parse_str_raw(c, &str, &m.klen)) != PHOT_PARSE_OK) {
-            break;
+}
+
+// 从 m+ 开始逐位生成数字，直到剩余部分落入区间 [m-, m+] 内，返回位数并累加十进制指数到 k
+static int phot_grisu_digits(phot_diy_fp w, phot_diy_fp mp, uint64_t delta, char *buf, int *k)
+{
+    int shift = -mp.e;
+    uint64_t one = 1ULL << shift, wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> shift);  // 整数部分
+    uint64_t p2 = mp.f & (one - 1);           // 小数部分
+    int len = 0, kappa = 1;
+    while (kappa < 10 && p1 >= phot_pow10_u64[kappa]) {
+        kappa++;
+    }
+    while (kappa > 0) {
+        uint32_t pow10 = (uint32_t)phot_pow10_u64[--kappa];
+        uint32_t d = p1 / pow10;
+        p1 %= pow10;
+        if (d != 0 || len != 0) {
+            buf[len++] = (char)('0' + d);
         }
-        memcpy(m.key = (char *)malloc(m.klen + 1), str, m.klen);
-        m.key[m.klen] = '\0';
-        // 解析冒号及前后空白
-        phot_parse_whitespace(c);
-        if (*c->json != ':') {
-            ret = PHOT_PARSE_MISS_COLON;
-            break;
+        uint64_t rest = ((uint64_t)p1 << shift) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            phot_grisu_round(buf, len, delta, rest, phot_pow10_u64[kappa] << shift, wp_w);
+            return len;
         }
-        c->json++;
-        phot_parse_whitespace(c);
-        // 解析成员值
-        if ((ret = phot_parse_value(c, &m.value)) != PHOT_PARSE_OK) {
-            break;
+    }
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> shift);
+        if (d != 0 || len != 0) {
+            buf[len++] = (char)('0' + d);
         }
-        memcpy(phot_context_push(c, sizeof(phot_member)), &m, sizeof(phot_member));
-        len++;
-        m.key = NULL;  // 此时 m.key 的所有权已经转移到 context 栈上
-        // 解析下一个成员或结束
-        phot_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-            phot_parse_whitespace(c);
-        } else if (*c->json == '}') {
-            c->json++;
-            phot_set_obj(e, len);
-            memcpy(e->obj, phot_context_pop(c, len * sizeof(phot_member)), len * sizeof(phot_member));
-            e->olen = len;
-            return PHOT_PARSE_OK;
-        } else {
-            ret = PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            phot_grisu_round(buf, len, delta, p2, one, -kappa < 20 ? wp_w * phot_pow10_u64[-kappa] : 0);
+            return len;
         }
     }
-    // 将 context 里的成员出栈并释放
-    free(m.key);
-    for (size_t i = 0; i < len; i++) {
-        phot_member *member = (phot_member *)phot_context_pop(c, sizeof(phot_member));
-        free(member->key);
-        phot_free(&member->value);
+}
+
+// 生成正的有限数 bits 的有效数字，返回位数，数值等于 buf * 10^k
+static int phot_grisu2(uint64_t bits, char *buf, int *k)
+{
+    int biased_e = (int)(bits >> 52);
+    uint64_t sig = bits & DOUBLE_SIG_MASK;
+    phot_diy_fp v = biased_e != 0 ? (phot_diy_fp){sig | DOUBLE_HIDDEN_BIT, biased_e - 1075} : (phot_diy_fp){sig, -1074};
+    // 与相邻 double 的中点 m+ 与 m-，指数对齐到规格化后的 m+
+    phot_diy_fp mp = phot_diy_fp_normalize((phot_diy_fp){(v.f << 1) + 1, v.e - 1});
+    phot_diy_fp mm = sig == 0 && biased_e > 1 ? (phot_diy_fp){(v.f << 2) - 1, v.e - 2}
+                                              : (phot_diy_fp){(v.f << 1) - 1, v.e - 1};
+    mm.f <<= mm.e - mp.e;
+    mm.e = mp.e;
+    // 选取 10^-k 使乘积的二进制指数落在 [-60, -32]，此时整数部分能放入 32 位
+    double dk = (-61 - mp.e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) {
+        ik++;
     }
-    e->type = PHOT_NULL;
-    return ret;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = 348 - (int)(index << 3);
+    phot_diy_fp c_mk = {phot_cached_pow10_f[index], phot_cached_pow10_e[index]};
+    phot_diy_fp w = phot_diy_fp_mul(phot_diy_fp_normalize(v), c_mk);
+    mp = phot_diy_fp_mul(mp, c_mk);
+    mm = phot_diy_fp_mul(mm, c_mk);
+    // 收缩 1 ulp 以抵消乘法的误差，保证生成的数字一定落在舍入区间内
+    mm.f++;
+    mp.f--;
+    return phot_grisu_digits(w, mp, mp.f - mm.f, buf, k);
 }
 
-static int phot_parse_value(phot_context *c, phot_elem *e)
+// 每次输出两位数字，返回写入的字符数
+static size_t phot_u64toa(uint64_t n, char *buf)
 {
-    switch (*c->json) {
-        case '"':
-            return phot_parse_str(c, e);
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-        case '-':
-            return phot_parse_num(c, e);
-        case '[':
-            return phot_parse_arr(c, e);
-        case '{':
-            return phot_parse_obj(c, e);
-        case 't':
-        case 'f':
-            return phot_parse_bool(c, e);
-        case 'n':
-            return phot_parse_null(c, e);
-        case '\0':
-            return PHOT_PARSE_EXPECT_VALUE;
-        default:
-            return PHOT_PARSE_INVALID_VALUE;
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    while (n >= 100) {
+        p -= 2;
+        memcpy(p, phot_digit_pairs + n % 100 * 2, 2);
+        n /= 100;
+    }
+    if (n >= 10) {
+        p -= 2;
+        memcpy(p, phot_digit_pairs + n * 2, 2);
+    } else {
+        *--p = (char)('0' + n);
     }
+    size_t len = tmp + sizeof(tmp) - p;
+    memcpy(buf, p, len);
+    return len;
 }
 
-int phot_parse(phot_elem *e, const char *json)
+// 将 num 转换为能往返的最短字符串写入 buf，最多写入 24 个字符，返回写入的字符数
+static size_t phot_dtoa(double num, char *buf)
 {
-    assert(e != NULL);
-    int ret;
-    phot_context c;
-    c.json = json;
-    c.stack = NULL;
-    c.size = c.top = 0;
-    phot_init(e);
-    phot_parse_whitespace(&c);
-    if ((ret = phot_parse_value(&c, e)) == PHOT_PARSE_OK) {
-        phot_parse_whitespace(&c);
-        if (*c.json != '\0') {
-            e->type = PHOT_NULL;
-            ret = PHOT_PARSE_ROOT_NOT_SINGULAR;
+    uint64_t bits;
+    memcpy(&bits, &num, sizeof(bits));
+    if (UNLIKELY((bits & DOUBLE_INF_BITS) == DOUBLE_INF_BITS)) {
+        // JSON 无法表示 inf 与 nan，保持原有的输出
+        return sprintf(buf, "%.17g", num);
+    }
+    char *p = buf;
+    if (bits >> 63) {
+        *p++ = '-';
+        bits &= ~(1ULL << 63);
+        num = -num;
+    }
+    if (bits == 0) {
+        *p++ = '0';
+        return p - buf;
+    }
+    // 小于 10^17 的整数在 "%.17g" 下按定点格式输出全部数字
+    if (num < 1e17 && num == (double)(uint64_t)num) {
+        return p - buf + phot_u64toa((uint64_t)num, p);
+    }
+    char digits[24];
+    int k, len = phot_grisu2(bits, digits, &k);
+    while (digits[len - 1] == '0') {
+        len--;
+        k++;
+    }
+    int exp10 = len + k - 1;  // 首位数字的十进制指数
+    if (exp10 < -4 || exp10 >= 17) {
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
         }
+        *p++ = 'e';
+        *p++ = exp10 < 0 ? '-' : '+';
+        unsigned x = exp10 < 0 ? -exp10 : exp10;
+        if (x >= 100) {
+            *p++ = (char)('0' + x / 100);
+            x %= 100;
+        }
+        memcpy(p, phot_digit_pairs + x * 2, 2);
+        p += 2;
+    } else if (exp10 < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -exp10 - 1);
+        p += -exp10 - 1;
+        memcpy(p, digits, len);
+        p += len;
+    } else if (len <= exp10 + 1) {
+        memcpy(p, digits, len);
+        memset(p + len, '0', exp10 + 1 - len);
+        p += exp10 + 1;
+    } else {
+        memcpy(p, digits, exp10 + 1);
+        p += exp10 + 1;
+        *p++ = '.';
+        memcpy(p, digits + exp10 + 1, len - exp10 - 1);
+        p += len - exp10 - 1;
     }
-    assert(c.top == 0);
-    free(c.stack);
-    return ret;
+    return p - buf;
 }
 
-static void phot_stringify_str(phot_context *c, const char *str, size_t len)
+// 流式序列化时，输出超过一个缓冲区就交给回调并清空栈，失败后不再调用回调
+static void phot_writer_flush(phot_context *c)
+{
+    if (c->top > 0 && !c->write_failed && !c->write(c->ud, c->stack, c->top)) {
+        c->write_failed = true;
+    }
+    c->top = 0;
+}
+
+static inline void phot_writer_check(phot_context *c)
+{
+    if (c->write != NULL && c->top >= PHOT_WRITER_BUF_SIZE) {
+        phot_writer_flush(c);
+    }
+}
+
+// 把需要转义的字符 ch 写到 p，返回写入的结尾
+static inline char *phot_escape_char(char *p, unsigned char ch)
 {
     static const char hex_digits[] = {
         '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
     };
+    *p++ = '\\';
+    switch (ch) {
+        case '\"':
+            *p++ = '\"';
+            break;
+        case '\\':
+            *p++ = '\\';
+            break;
+        case '\b':
+            *p++ = 'b';
+            break;
+        case '\f':
+            *p++ = 'f';
+            break;
+        case '\n':
+            *p++ = 'n';
+            break;
+        case '\r':
+            *p++ = 'r';
+            break;
+        case '\t':
+            *p++ = 't';
+            break;
+        default:
+            *p++ = 'u';
+            *p++ = '0';
+            *p++ = '0';
+            *p++ = hex_digits[ch >> 4];
+            *p++ = hex_digits[ch & 0xF];
+    }
+    return p;
+}
+
+// 把 str 转义后写到 p，返回写入的结尾，每个字符最多占 6 个字符
+// 余下至少 16 个字节时用解析时的 phot_scan_str 找下一个需要转义的字符，其间的部分整段拷贝；
+// 更短的结尾逐字节处理，省下函数指针和 memcpy 的调用
+static inline char *phot_escape_str(char *p, const char *str, size_t len)
+{
+    const char *end = str + len;
+    while (end - str >= 16) {
+        const char *run = str;
+        str = phot_scan_str(str, end);
+        memcpy(p, run, str - run);
+        p += str - run;
+        if (str == end) {
+            return p;
+        }
+        p = phot_escape_char(p, (unsigned char)*str++);
+    }
+    while (str != end) {
+        unsigned char ch = (unsigned char)*str++;
+        if (LIKELY(!is_str_special((char)ch))) {
+            *p++ = (char)ch;
+        } else {
+            p = phot_escape_char(p, ch);
+        }
+    }
+    return p;
+}
+
+// 长字符串分段转义，每段按最坏情况预留的空间不超过缓冲区的一半，而不是整个字符串的 6 倍
+// 流式序列化时每段之后都可以写出
+NOINLINE static void phot_stringify_long_str(phot_context *c, const char *str, size_t len)
+{
+    const size_t chunk = PHOT_WRITER_BUF_SIZE / 12;
+    phot_push_ch(c, '"');
+    while (len > 0) {
+        size_t n = len < chunk ? len : chunk;
+        char *head = phot_context_push(c, n * 6);
+        c->top -= n * 6 - (phot_escape_str(head, str, n) - head);
+        str += n;
+        len -= n;
+        phot_writer_check(c);
+    }
+    phot_push_ch(c, '"');
+}
+
+static void phot_stringify_str(phot_context *c, const char *str, size_t len)
+{
     assert(str != NULL);
-    size_t size = len * 6 + 2;  // 每个字符最多占 6 个字符和 2 个引号
+    if (UNLIKELY(len > PHOT_WRITER_BUF_SIZE / 12)) {
+        phot_stringify_long_str(c, str, len);
+        return;
+    }
+    size_t size = len * 6 + 2;  // 加上两个引号
     char *head = phot_context_push(c, size);
     char *p = head;
     *p++ = '"';
-    for (size_t i = 0; i < len; i++) {
-        unsigned char ch = (unsigned char)str[i];
-        switch (ch) {
-            case '\"':
-                *p++ = '\\';
-                *p++ = '\"';
-                break;
-            case '\\':
-                *p++ = '\\';
-                *p++ = '\\';
-                break;
-            case '\b':
-                *p++ = '\\';
-                *p++ = 'b';
-                break;
-            case '\f':
-                *p++ = '\\';
-                *p++ = 'f';
-                break;
-            case '\n':
-                *p++ = '\\';
-                *p++ = 'n';
-                break;
-            case '\r':
-                *p++ = '\\';
-                *p++ = 'r';
-                break;
-            case '\t':
-                *p++ = '\\';
-                *p++ = 't';
-                break;
-            default:
-                if (ch < 0x20) {
-                    *p++ = '\\';
-                    *p++ = 'u';
-                    *p++ = '0';
-                    *p++ = '0';
-                    *p++ = hex_digits[ch >> 4];
-                    *p++ = hex_digits[ch & 0xF];
-                } else {
-                    *p++ = ch;
-                }
-        }
-    }
+    p = phot_escape_str(p, str, len);
     *p++ = '"';
     c->top -= size - (p - head);
 }
 
-static void phot_stringify_value(phot_context *c, const phot_elem *e)
+// 标量和空容器，非空的数组和对象由 phot_stringify_value 展开
+static void phot_stringify_leaf(phot_context *c, const phot_elem *e)
 {
     switch (e->type) {
         case PHOT_NULL:
@@ -525,76 +4015,357 @@ static void phot_stringify_value(phot_context *c, const phot_elem *e)
             phot_push_str(c, e->boolean ? "true" : "false", e->boolean ? 4 : 5);
             break;
         case PHOT_NUM:
-            // 将数字转换为字符串放入栈中，sprintf 返回的是写入的字符数
-            c->top -= 32 - sprintf(phot_context_push(c, 32), "%.17g", e->num);
+            c->top -= 32 - phot_dtoa(e->num, phot_context_push(c, 32));
             break;
         case PHOT_STR:
-            phot_stringify_str(c, e->str, e->slen);
+            phot_stringify_str(c, phot_str_ptr(e), phot_str_len(e));
             break;
         case PHOT_ARR:
-            phot_push_ch(c, '[');
-            for (size_t i = 0; i < e->alen; i++) {
-                if (i > 0) {
-                    phot_push_ch(c, ',');
-                }
-                phot_stringify_value(c, &e->arr[i]);
-            }
-            phot_push_ch(c, ']');
+            phot_push_str(c, "[]", 2);
             break;
         case PHOT_OBJ:
-            phot_push_ch(c, '{');
-            for (size_t i = 0; i < e->olen; i++) {
-                if (i > 0) {
-                    phot_push_ch(c, ',');
-                }
-                phot_stringify_str(c, e->obj[i].key, e->obj[i].klen);
-                phot_push_ch(c, ':');
-                phot_stringify_value(c, &e->obj[i].value);
-            }
-            phot_push_ch(c, '}');
+            phot_push_str(c, "{}", 2);
             break;
         default:
             assert(0 && "invalid type");
     }
 }
 
-char *phot_stringify(const phot_elem *e, size_t *len)
+// 换行并缩进 depth 层
+static void phot_pretty_newline(phot_context *c, size_t depth)
 {
-    assert(e != NULL);
+    const phot_pretty *f = c->pretty;
+    size_t n = depth * f->indent;
+    size_t len = n < PHOT_INDENT_RUN ? n : PHOT_INDENT_RUN;
+    memcpy(phot_context_push(c, f->newline + len), f->run, f->newline + len);
+    for (n -= len; n > 0; n -= len) {
+        len = n < PHOT_INDENT_RUN ? n : PHOT_INDENT_RUN;
+        memcpy(phot_context_push(c, len), f->run + f->newline, len);
+    }
+}
+
+// 非递归地序列化：非空容器输出左括号后压栈，之后依次输出栈顶容器的子元素，遇到非空的子容器时进入，
+// 子元素输出完时输出右括号并出栈；美化输出时容器的每个元素各占一行，缩进层数就是栈的深度
+// pretty 总是以常量传入，紧凑输出和美化输出各自展开成一份，紧凑输出不必检查格式
+static ALWAYS_INLINE void phot_stringify_tree(phot_context *c, const phot_elem *e, bool pretty)
+{
+    const phot_pretty *f = c->pretty;
+    bool indent = pretty && f->indent > 0;
+    phot_walk w;
+    phot_walk_init(&w);
+    phot_push_ch(c, e->type == PHOT_ARR ? '[' : '{');
+    phot_walk_push(&w, e, NULL);
+    while (w.depth > 0) {
+        // 下标和长度放在局部变量中，输出时写栈不会迫使编译器重新读取它们
+        phot_frame *top = &w.frame[w.depth - 1];
+        const phot_elem *p = top->src, *child = NULL;
+        size_t i = top->i, n = p->len;
+        for (; i < n; i++) {
+            if (i > 0) {
+                phot_push_ch(c, ',');
+            }
+            if (indent) {
+                phot_pretty_newline(c, w.depth);
+            }
+            if (p->type == PHOT_ARR) {
+                child = &p->arr[i];
+            } else {
+                phot_stringify_str(c, phot_str_ptr(&p->obj[i].key), phot_str_len(&p->obj[i].key));
+                if (pretty && f->space) {
+                    phot_push_str(c, ": ", 2);
+                } else {
+                    phot_push_ch(c, ':');
+                }
+                child = &p->obj[i].value;
+            }
+            phot_lazy_load(child);
+            if (phot_has_children(child)) break;
+            phot_stringify_leaf(c, child);
+            phot_writer_check(c);
+            child = NULL;
+        }
+        if (child != NULL) {
+            top->i = i + 1;
+            phot_push_ch(c, child->type == PHOT_ARR ? '[' : '{');
+            phot_walk_push(&w, child, NULL);
+            continue;
+        }
+        w.depth--;
+        if (indent) {
+            phot_pretty_newline(c, w.depth);
+        }
+        phot_push_ch(c, p->type == PHOT_ARR ? ']' : '}');
+        phot_writer_check(c);
+    }
+    phot_walk_free(&w);
+}
+
+static void phot_stringify_value(phot_context *c, const phot_elem *e)
+{
+    phot_lazy_load(e);
+    if (!phot_has_children(e)) {
+        phot_stringify_leaf(c, e);
+    } else if (c->pretty != NULL) {
+        phot_stringify_tree(c, e, true);
+    } else {
+        phot_stringify_tree(c, e, false);
+    }
+}
+
+// 按格式序列化 e，没有要求任何格式时走紧凑输出
+static void phot_stringify_root(phot_context *c, const phot_elem *e, const phot_stringify_opts *opts)
+{
+    if (opts == NULL || (opts->indent == 0 && !opts->space_after_colon)) {
+        c->pretty = NULL;
+        phot_stringify_value(c, e);
+        return;
+    }
+    assert(opts->indent_char == '\0' || opts->indent_char == ' ' || opts->indent_char == '\t');
+    phot_pretty f;
+    f.newline = 0;
+    if (opts->crlf) {
+        f.run[f.newline++] = '\r';
+    }
+    f.run[f.newline++] = '\n';
+    memset(f.run + f.newline, opts->indent_char != '\0' ? opts->indent_char : ' ', PHOT_INDENT_RUN);
+    f.indent = opts->indent;
+    f.space = opts->space_after_colon;
+    c->pretty = &f;
+    phot_stringify_value(c, e);
+    c->pretty = NULL;
+}
+
+void phot_writer_init(phot_writer *w)
+{
+    assert(w != NULL);
+    w->buf = NULL;
+    w->size = 0;
+    w->trim = 0;
+}
+
+const char *phot_stringify_with(phot_writer *w, const phot_elem *e, const phot_stringify_opts *opts, size_t *len)
+{
+    assert(w != NULL && e != NULL);
+    // 上一次的输出此时已失效，先缩回再复用
+    phot_scratch_trim(&w->buf, &w->size, w->trim);
+    if (w->size == 0) {
+        w->size = PHOT_PARSE_STRINGIFY_INIT_SIZE;
+        w->buf = (char *)phot_mem_alloc(w->size);
+    }
     phot_context c;
-    c.size = PHOT_PARSE_STRINGIFY_INIT_SIZE;
-    c.stack = (char *)malloc(c.size);
+    c.stack = w->buf;
+    c.size = w->size;
     c.top = 0;
-    phot_stringify_value(&c, e);
+    c.doc = NULL;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = NULL;
+    c.handler = NULL;
+    c.ud = NULL;
+    c.write = NULL;
+    phot_stringify_root(&c, e, opts);
     if (len != NULL) {
         *len = c.top;
     }
     phot_push_ch(&c, '\0');
-    return c.stack;
+    w->buf = c.stack;
+    w->size = c.size;
+    return w->buf;
 }
 
-phot_elem *phot_read_from_file(const char *filename)
+void phot_writer_free(phot_writer *w)
 {
-    FILE *fp = fopen(filename, "r");
-    if (fp == NULL) {
-        fprintf(stderr, "Failed to open file: %s\n", filename);
-        return NULL;
+    assert(w != NULL);
+    phot_mem_free(w->buf, w->size);
+    w->buf = NULL;
+    w->size = 0;
+}
+
+char *phot_stringify_ex(const phot_elem *e, const phot_stringify_opts *opts, size_t *len)
+{
+    // 一次性的序列化器，缓冲区直接交给调用者
+    phot_writer w;
+    phot_writer_init(&w);
+    return (char *)phot_stringify_with(&w, e, opts, len);
+}
+
+char *phot_stringify(const phot_elem *e, size_t *len) { return phot_stringify_ex(e, NULL, len); }
+
+int phot_stringify_to_ex(const phot_elem *e, const phot_stringify_opts *opts, phot_write_cb write, void *ud)
+{
+    assert(e != NULL && write != NULL);
+    phot_context c;
+    // 留出余量，一个缓冲区加上跨过检查点的最后一段输出通常不必再扩容
+    c.size = PHOT_WRITER_BUF_SIZE + PHOT_WRITER_BUF_SIZE / 2;
+    c.stack = (char *)phot_mem_alloc(c.size);
+    c.top = 0;
+    c.doc = NULL;
+    c.insitu = false;
+    c.index = NULL;
+    c.keys = NULL;
+    c.handler = NULL;
+    c.ud = ud;
+    c.write = write;
+    c.write_failed = false;
+    phot_stringify_root(&c, e, opts);
+    phot_writer_flush(&c);
+    phot_mem_free(c.stack, c.size);
+    return c.write_failed ? -1 : 0;
+}
+
+int phot_stringify_to(const phot_elem *e, phot_write_cb write, void *ud)
+{
+    return phot_stringify_to_ex(e, NULL, write, ud);
+}
+
+static bool phot_write_fp(void *ud, const char *buf, size_t len) { return fwrite(buf, 1, len, (FILE *)ud) == len; }
+
+int phot_stringify_fp(const phot_elem *e, FILE *fp)
+{
+    assert(fp != NULL);
+    return phot_stringify_to(e, phot_write_fp, fp);
+}
+
+#if PHOT_USE_FD
+// 处理部分写入和被信号打断的情况
+static bool phot_write_fd(void *ud, const char *buf, size_t len)
+{
+    int fd = *(const int *)ud;
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+#endif
+
+int phot_stringify_fd(const phot_elem *e, int fd)
+{
+#if PHOT_USE_FD
+    return phot_stringify_to(e, phot_write_fd, &fd);
+#else
+    (void)e;
+    (void)fd;
+    return -1;
+#endif
+}
+
+#if PHOT_USE_MMAP
+// 把普通文件只读映射到内存，管道、设备等其它文件或映射失败时返回 false
+static bool phot_mmap_file(FILE *fp, phot_file_map *m)
+{
+    struct stat st;
+    int fd = fileno(fp);
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) return false;
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return false;
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    m->data = (const char *)data;
+    m->len = (size_t)st.st_size;
+    m->mapped = true;
+    return true;
+}
+#endif
+
+int phot_map_file(phot_file_map *m, const char *filename)
+{
+    assert(m != NULL && filename != NULL);
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) return -1;
+#if PHOT_USE_MMAP
+    if (phot_mmap_file(fp, m)) {
+        fclose(fp);
+        return 0;
+    }
+#endif
+    // 无法映射时读入堆内存
+    size_t cap = PHOT_READ_CHUNK_SIZE, len = 0, n;
+    char *data = (char *)phot_mem_alloc(cap);
+    while ((n = fread(data + len, 1, cap - len, fp)) > 0) {
+        len += n;
+        if (len == cap) {
+            cap *= 2;
+            data = (char *)phot_mem_realloc(data, cap / 2, cap);
+        }
+    }
+    bool failed = ferror(fp);
+    fclose(fp);
+    if (failed) {
+        phot_mem_free(data, cap);
+        return -1;
+    }
+    m->data = data;
+    m->len = len;
+    m->mapped = false;
+    return 0;
+}
+
+void phot_unmap_file(phot_file_map *m)
+{
+    assert(m != NULL);
+#if PHOT_USE_MMAP
+    if (m->mapped) {
+        munmap((void *)m->data, m->len);
+    } else {
+        phot_mem_free((void *)m->data, 0);
     }
+#else
+    phot_mem_free((void *)m->data, 0);
+#endif
+    m->data = NULL;
+    m->len = 0;
+}
 
-    fseek(fp, 0, SEEK_END);
-    long size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    char *json = (char *)malloc(size + 1);
-    fread(json, 1, size, fp);
-    json[size] = '\0';
+int phot_parse_file(phot_elem *e, const char *filename)
+{
+    assert(e != NULL && filename != NULL);
+    phot_init(e);
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) return PHOT_PARSE_FILE_ERROR;
+#if PHOT_USE_MMAP
+    phot_file_map m;
+    if (phot_mmap_file(fp, &m)) {
+        // 按长度解析，不需要结尾的 '\0'，字符串都会被复制，所以解析完即可解除映射
+        fclose(fp);
+        int ret = phot_parse_n(e, m.data, m.len);
+        phot_unmap_file(&m);
+        return ret;
+    }
+#endif
+    // 管道等无法映射的文件分块读入增量解析器
+    phot_stream s;
+    phot_stream_init(&s, e);
+    char *buf = (char *)phot_mem_alloc(PHOT_READ_CHUNK_SIZE);
+    size_t n;
+    while ((n = fread(buf, 1, PHOT_READ_CHUNK_SIZE, fp)) > 0 && phot_stream_feed(&s, buf, n) == PHOT_PARSE_OK) {
+    }
+    bool failed = ferror(fp);
+    phot_mem_free(buf, PHOT_READ_CHUNK_SIZE);
     fclose(fp);
+    int ret = phot_stream_finish(&s);
+    if (failed && ret == PHOT_PARSE_OK) {
+        phot_free(e);
+        ret = PHOT_PARSE_FILE_ERROR;
+    }
+    return ret;
+}
 
-    phot_elem *e = (phot_elem *)malloc(sizeof(phot_elem));
-    int ret = phot_parse(e, json);
-    free(json);
+phot_elem *phot_read_from_file(const char *filename)
+{
+    phot_elem *e = (phot_elem *)phot_mem_alloc(sizeof(phot_elem));
+    int ret = phot_parse_file(e, filename);
     if (ret != PHOT_PARSE_OK) {
-        free(e);
-        fprintf(stderr, "Failed to parse JSON: %d\n", ret);
+        phot_mem_free(e, sizeof(phot_elem));
+        if (ret == PHOT_PARSE_FILE_ERROR) {
+            fprintf(stderr, "Failed to open file: %s\n", filename);
+        } else {
+            fprintf(stderr, "Failed to parse JSON: %d\n", ret);
+        }
         return NULL;
     }
     return e;
@@ -608,44 +4379,267 @@ int phot_write_to_file(const phot_elem *e, const char *filename)
         return -1;
     }
 
-    size_t len;
-    char *json = phot_stringify(e, &len);
-    if (fwrite(json, 1, len, fp) != len) {
+    // 边序列化边写入，不必先在内存中拼出整个字符串
+    int ret = phot_stringify_fp(e, fp);
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+    if (ret != 0) {
         fprintf(stderr, "Failed to write to file: %s\n", filename);
-        free(json);
-        fclose(fp);
         return -1;
     }
-    free(json);
-    fclose(fp);
     return 0;
 }
 
-void phot_copy(phot_elem *dst, const phot_elem *src)
+// NDJSON：输入按批分给各线程，每批截断在换行处，所以记录不会跨批；每个线程把整批记录解析到自己的文档 arena 中
+// 有序交付时各批按序号轮流回调，解析仍是并行的，同时在途的批次不超过线程数
+
+typedef struct {
+    phot_elem elem;
+    size_t offset;  // 记录在输入中的字节偏移
+    int status;
+} phot_ndjson_record;
+
+typedef struct {
+    const char *buf;
+    size_t len;
+    size_t pos;         // 下一批的起始位置
+    size_t next_batch;  // 下一批的序号
+    size_t turn;        // 有序交付时轮到的批次
+    bool ordered;
+    bool stop;  // 回调要求中止，之后不再开始新的批次
+    phot_intern *keys;
+    const phot_allocator *alloc;  // 各线程文档的分配器
+    phot_ndjson_cb cb;
+    void *ud;
+#if PHOT_USE_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} phot_ndjson;
+
+// 以下共享状态的同步操作在单线程构建中都是空操作
+static inline void phot_ndjson_lock(phot_ndjson *nd)
 {
-    assert(dst != NULL && src != NULL && dst != src);
-    phot_free(dst);
+#if PHOT_USE_THREADS
+    pthread_mutex_lock(&nd->lock);
+#else
+    (void)nd;
+#endif
+}
+
+static inline void phot_ndjson_unlock(phot_ndjson *nd)
+{
+#if PHOT_USE_THREADS
+    pthread_mutex_unlock(&nd->lock);
+#else
+    (void)nd;
+#endif
+}
+
+// 在持有锁时等待其它线程交付完前面的批次，单线程时批次总是按序处理，不会真的等待
+static inline void phot_ndjson_wait(phot_ndjson *nd)
+{
+#if PHOT_USE_THREADS
+    pthread_cond_wait(&nd->cond, &nd->lock);
+#else
+    (void)nd;
+    assert(0 && "ndjson batches out of order");
+#endif
+}
+
+static inline void phot_ndjson_broadcast(phot_ndjson *nd)
+{
+#if PHOT_USE_THREADS
+    pthread_cond_broadcast(&nd->cond);
+#else
+    (void)nd;
+#endif
+}
+
+// 取下一批，返回批次的长度，没有剩余输入或已中止时返回 0
+static size_t phot_ndjson_next(phot_ndjson *nd, const char **begin, size_t *batch)
+{
+    phot_ndjson_lock(nd);
+    size_t n = nd->stop ? 0 : nd->len - nd->pos;
+    if (n > PHOT_NDJSON_BATCH_SIZE) {
+        const char *p = nd->buf + nd->pos + PHOT_NDJSON_BATCH_SIZE;
+        const char *nl = (const char *)memchr(p, '\n', n - PHOT_NDJSON_BATCH_SIZE);
+        if (nl != NULL) {
+            n = nl + 1 - (nd->buf + nd->pos);
+        }
+    }
+    *begin = nd->buf + nd->pos;
+    *batch = nd->next_batch++;
+    nd->pos += n;
+    phot_ndjson_unlock(nd);
+    return n;
+}
+
+static void *phot_ndjson_worker(void *arg)
+{
+    phot_ndjson *nd = (phot_ndjson *)arg;
+    phot_doc doc;
+    phot_doc_init(&doc);
+    doc.keys = nd->keys;
+    doc.alloc = nd->alloc;
+    phot_ndjson_record *records = NULL;
+    size_t cap = 0;
+    const char *p;
+    size_t n, batch;
+    while ((n = phot_ndjson_next(nd, &p, &batch)) > 0) {
+        // 解析整批记录，空白行不算记录
+        const char *const end = p + n;
+        size_t count = 0;
+        phot_doc_reset(&doc);
+        while (p < end) {
+            const char *nl = (const char *)memchr(p, '\n', end - p);
+            const char *line_end = nl != NULL ? nl : end;
+            if (phot_skip_ws(p, line_end) != line_end) {
+                if (count == cap) {
+                    size_t old_cap = cap;
+                    cap = cap == 0 ? 256 : cap * 2;
+                    records = (phot_ndjson_record *)phot_mem_realloc_with(nd->alloc, records, old_cap * sizeof(phot_ndjson_record),
+                                                                          cap * sizeof(phot_ndjson_record));
+                    assert(records != NULL);
+                }
+                phot_ndjson_record *r = &records[count++];
+                r->offset = p - nd->buf;
+                r->status = phot_doc_parse_n(&doc, &r->elem, p, line_end - p);
+            }
+            p = nl != NULL ? nl + 1 : end;
+        }
+        // 交付，有序时先等前面的批次交付完
+        bool stop = false;
+        if (nd->ordered) {
+            phot_ndjson_lock(nd);
+            while (nd->turn != batch && !nd->stop) {
+                phot_ndjson_wait(nd);
+            }
+            stop = nd->stop;
+            phot_ndjson_unlock(nd);
+        }
+        for (size_t i = 0; i < count && !stop; i++) {
+            stop = !nd->cb(nd->ud, records[i].offset, records[i].status, &records[i].elem);
+        }
+        if (nd->ordered || stop) {
+            phot_ndjson_lock(nd);
+            nd->stop |= stop;
+            nd->turn++;
+            phot_ndjson_broadcast(nd);
+            phot_ndjson_unlock(nd);
+        }
+    }
+    phot_mem_free_with(nd->alloc, records, cap * sizeof(phot_ndjson_record));
+    phot_doc_free(&doc);
+    return NULL;
+}
+
+int phot_parse_ndjson(const char *buf, size_t len, const phot_ndjson_opts *opts, phot_ndjson_cb cb, void *ud)
+{
+    assert(buf != NULL && cb != NULL);
+    phot_ndjson nd;
+    nd.buf = buf;
+    nd.len = len;
+    nd.pos = nd.next_batch = nd.turn = 0;
+    nd.ordered = opts != NULL ? opts->ordered : true;
+    nd.stop = false;
+    nd.keys = opts != NULL ? opts->keys : NULL;
+    nd.alloc = opts != NULL ? opts->alloc : NULL;
+    nd.cb = cb;
+    nd.ud = ud;
+#if PHOT_USE_THREADS
+    size_t threads = opts != NULL ? opts->threads : 0;
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+    // 不创建分不到批次的线程
+    size_t batches = len / PHOT_NDJSON_BATCH_SIZE + 1;
+    if (threads > batches) {
+        threads = batches;
+    }
+    pthread_mutex_init(&nd.lock, NULL);
+    pthread_cond_init(&nd.cond, NULL);
+    pthread_t *tids = (pthread_t *)phot_mem_alloc_with(nd.alloc, threads * sizeof(pthread_t));
+    assert(tids != NULL);
+    // 当前线程也是工作线程之一，创建失败时就用已有的线程继续
+    size_t spawned = 0;
+    while (spawned + 1 < threads && pthread_create(&tids[spawned], NULL, phot_ndjson_worker, &nd) == 0) {
+        spawned++;
+    }
+    phot_ndjson_worker(&nd);
+    for (size_t i = 0; i < spawned; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    phot_mem_free_with(nd.alloc, tids, threads * sizeof(pthread_t));
+    pthread_cond_destroy(&nd.cond);
+    pthread_mutex_destroy(&nd.lock);
+#else
+    phot_ndjson_worker(&nd);
+#endif
+    return nd.stop ? PHOT_PARSE_ABORTED : PHOT_PARSE_OK;
+}
+
+// 把 src 本身复制到空元素 dst 中，容器只创建容量相同的空容器
+static void phot_copy_node(phot_elem *dst, const phot_elem *src)
+{
+    phot_lazy_load(src);
     switch (src->type) {
         case PHOT_STR:
-            phot_set_str(dst, src->str, src->slen);
+            phot_set_str(dst, phot_str_ptr(src), phot_str_len(src));
             break;
         case PHOT_ARR:
-            phot_set_arr(dst, src->alen);
-            for (size_t i = 0; i < src->alen; i++) {
-                phot_copy(&dst->arr[i], &src->arr[i]);
-            }
-            dst->alen = src->alen;
+            phot_set_arr(dst, src->len);
             break;
         case PHOT_OBJ:
-            phot_set_obj(dst, src->olen);
-            for (size_t i = 0; i < src->olen; i++) {
-                phot_elem *value = phot_set_obj_value(dst, src->obj[i].key, src->obj[i].klen);
-                phot_copy(value, &src->obj[i].value);
-            }
+            phot_set_obj(dst, src->len);
             break;
         default:
             memcpy(dst, src, sizeof(phot_elem));
+            dst->flags = 0;  // 副本是普通的零值，不再带 PHOT_FLAG_INVALID
+    }
+}
+
+void phot_copy(phot_elem *dst, const phot_elem *src)
+{
+    assert(dst != NULL && src != NULL && dst != src);
+    phot_free(dst);
+    phot_copy_node(dst, src);
+    if (!phot_has_children(src)) return;
+    // 目标容器的容量与源相同，复制过程中子元素的地址不会移动
+    phot_walk w;
+    phot_walk_init(&w);
+    phot_walk_push(&w, src, dst);
+    while (w.depth > 0) {
+        phot_frame *top = &w.frame[w.depth - 1];
+        const phot_elem *from = top->src, *child = NULL;
+        phot_elem *to = top->dst, *copy = NULL;
+        while (top->i < from->len) {
+            size_t i = top->i++;
+            if (from->type == PHOT_ARR) {
+                child = &from->arr[i];
+                copy = &to->arr[i];
+                phot_init(copy);
+                to->len = phot_len32(i + 1);
+            } else {
+                // 重复的键会回到已经复制过的值上，先释放它
+                const phot_elem *key = &from->obj[i].key;
+                child = &from->obj[i].value;
+                copy = phot_set_obj_value(to, phot_str_ptr(key), phot_str_len(key));
+                phot_free(copy);
+            }
+            phot_copy_node(copy, child);
+            if (phot_has_children(child)) break;
+            child = NULL;
+        }
+        if (child != NULL) {
+            phot_walk_push(&w, child, copy);
+        } else {
+            w.depth--;
+        }
     }
+    phot_walk_free(&w);
 }
 
 void phot_move(phot_elem *dst, phot_elem *src)
@@ -667,30 +4661,74 @@ void phot_swap(phot_elem *lhs, phot_elem *rhs)
     }
 }
 
+// 释放元素本身持有的内存，容器的子元素须已释放
+static inline void phot_free_node(phot_elem *e)
+{
+    if (!(e->flags & (PHOT_FLAG_LAZY | PHOT_FLAG_BORROWED | PHOT_FLAG_INLINE))) {
+        switch (e->type) {
+            case PHOT_STR:
+                phot_mem_free(e->str, (size_t)e->len + 1);
+                break;
+            case PHOT_ARR:
+                if (e->arr != NULL) {
+                    phot_mem_free(phot_arr_head_of(e), phot_arr_size(phot_arr_cap(e)));
+                }
+                break;
+            case PHOT_OBJ:
+                if (e->obj != NULL) {
+                    phot_obj_index_free(*phot_obj_index_of(e));
+                    phot_mem_free(phot_obj_head_of(e), phot_obj_size(phot_obj_cap(e)));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    phot_init(e);
+}
+
 void phot_free(phot_elem *e)
 {
     assert(e != NULL);
-    switch (e->type) {
-        case PHOT_STR:
-            free(e->str);
-            break;
-        case PHOT_ARR:
-            for (size_t i = 0; i < e->alen; i++) {
-                phot_free(&e->arr[i]);
+    if (!phot_has_children(e)) {
+        phot_free_node(e);
+        return;
+    }
+    // 后序遍历：子元素全部释放后才释放容器；借用的缓冲区里仍可能有后来写入的堆上的值，所以照样遍历
+    phot_walk w;
+    phot_walk_init(&w);
+    phot_walk_push(&w, e, e);
+    while (w.depth > 0) {
+        phot_frame *top = &w.frame[w.depth - 1];
+        phot_elem *p = top->dst, *child = NULL;
+        if (p->type == PHOT_ARR) {
+            while (top->i < p->len) {
+                phot_elem *x = &p->arr[top->i++];
+                if (phot_has_children(x)) {
+                    child = x;
+                    break;
+                }
+                phot_free_node(x);
             }
-            free(e->arr);
-            break;
-        case PHOT_OBJ:
-            for (size_t i = 0; i < e->olen; i++) {
-                free(e->obj[i].key);
-                phot_free(&e->obj[i].value);
+        } else {
+            while (top->i < p->len) {
+                phot_member *m = &p->obj[top->i++];
+                phot_free_node(&m->key);
+                if (phot_has_children(&m->value)) {
+                    child = &m->value;
+                    break;
+                }
+                phot_free_node(&m->value);
             }
-            free(e->obj);
-            break;
-        default:
-            break;
+        }
+        if (child != NULL) {
+            phot_walk_push(&w, child, child);
+        } else {
+            phot_free_node(p);
+            w.depth--;
+        }
     }
-    e->type = PHOT_NULL;
+    phot_walk_free(&w);
 }
 
 phot_type phot_get_type(const phot_elem *e)
@@ -699,27 +4737,29 @@ phot_type phot_get_type(const phot_elem *e)
     return e->type;
 }
 
-bool phot_is_equal(const phot_elem *lhs, const phot_elem *rhs)
+int phot_get_status(const phot_elem *e)
 {
-    assert(lhs != NULL && rhs != NULL);
+    assert(e != NULL);
+    phot_lazy_load(e);
+    return (e->flags & PHOT_FLAG_INVALID) ? (unsigned char)e->sso_tail : PHOT_PARSE_OK;
+}
+
+// 比较元素本身，容器只比较类型和长度，*descend 返回是否还要比较子元素
+static bool phot_equal_node(const phot_elem *lhs, const phot_elem *rhs, bool *descend)
+{
+    *descend = false;
     if (lhs->type != rhs->type) return false;
+    phot_lazy_load(lhs);
+    phot_lazy_load(rhs);
     switch (lhs->type) {
         case PHOT_NUM:
             return lhs->num == rhs->num;
         case PHOT_STR:
-            return lhs->slen == rhs->slen && memcmp(lhs->str, rhs->str, lhs->slen) == 0;
+            return phot_str_len(lhs) == phot_str_len(rhs) && memcmp(phot_str_ptr(lhs), phot_str_ptr(rhs), phot_str_len(lhs)) == 0;
         case PHOT_ARR:
-            if (lhs->alen != rhs->alen) return false;
-            for (size_t i = 0; i < lhs->alen; i++) {
-                if (!phot_is_equal(&lhs->arr[i], &rhs->arr[i])) return false;
-            }
-            return true;
         case PHOT_OBJ:
-            if (lhs->olen != rhs->olen) return false;
-            for (size_t i = 0; i < lhs->olen; i++) {
-                phot_elem *value = phot_find_obj_value(lhs, rhs->obj[i].key, rhs->obj[i].klen);
-                if (value == NULL || !phot_is_equal(value, &rhs->obj[i].value)) return false;
-            }
+            if (lhs->len != rhs->len) return false;
+            *descend = lhs->len > 0;
             return true;
         case PHOT_BOOL:
             return lhs->boolean == rhs->boolean;
@@ -728,6 +4768,46 @@ bool phot_is_equal(const phot_elem *lhs, const phot_elem *rhs)
     }
 }
 
+bool phot_is_equal(const phot_elem *lhs, const phot_elem *rhs)
+{
+    assert(lhs != NULL && rhs != NULL);
+    bool descend, equal = true;
+    if (!phot_equal_node(lhs, rhs, &descend)) return false;
+    if (!descend) return true;
+    // 以 rhs 一侧为序遍历，对象的成员按键到 lhs 中查找
+    phot_walk w;
+    phot_walk_init(&w);
+    phot_walk_push(&w, rhs, (phot_elem *)lhs);
+    while (equal && w.depth > 0) {
+        phot_frame *top = &w.frame[w.depth - 1];
+        const phot_elem *r = top->src, *l = top->dst, *a = NULL, *b = NULL;
+        descend = false;
+        while (top->i < r->len) {
+            size_t i = top->i++;
+            if (r->type == PHOT_ARR) {
+                a = &l->arr[i];
+                b = &r->arr[i];
+            } else {
+                const phot_elem *key = &r->obj[i].key;
+                a = phot_find_obj_value(l, phot_str_ptr(key), phot_str_len(key));
+                b = &r->obj[i].value;
+            }
+            if (a == NULL || !phot_equal_node(a, b, &descend)) {
+                equal = false;
+                break;
+            }
+            if (descend) break;
+        }
+        if (descend) {
+            phot_walk_push(&w, b, (phot_elem *)a);
+        } else {
+            w.depth--;
+        }
+    }
+    phot_walk_free(&w);
+    return equal;
+}
+
 void phot_set_bool(phot_elem *e, bool boolean)
 {
     phot_free(e);
@@ -751,88 +4831,106 @@ void phot_set_num(phot_elem *e, double num)
 double phot_get_num(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_NUM);
+    phot_lazy_load(e);
     return e->num;
 }
 
-void phot_set_str(phot_elem *e, const char *str, size_t len)
+bool phot_set_str(phot_elem *e, const char *str, size_t len)
 {
     // 元素 e 不能为空，字符串 str 可以为空但长度 len 必须为 0
     assert(e != NULL && (str != NULL || len == 0));
+    if (UNLIKELY(!phot_len_fits(len))) return false;
     phot_free(e);
-    e->str = (char *)malloc(len + 1);
-    assert(e->str != NULL);
-    memcpy(e->str, str, len);
-    e->str[len] = '\0';
-    e->slen = len;
-    e->type = PHOT_STR;
+    phot_str_init(e, str, len);
+    return true;
 }
 
 const char *phot_get_str(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_STR);
-    return e->str;
+    phot_lazy_load(e);
+    return phot_str_ptr(e);
 }
 
 size_t phot_get_str_len(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_STR);
-    return e->slen;
+    phot_lazy_load(e);
+    return phot_str_len(e);
 }
 
-void phot_set_arr(phot_elem *e, size_t cap)
+bool phot_set_arr(phot_elem *e, size_t cap)
 {
     assert(e != NULL);
+    if (UNLIKELY(!phot_len_fits(cap))) return false;
     phot_free(e);
-    e->arr = cap > 0 ? (phot_elem *)calloc(cap, sizeof(phot_elem)) : NULL;
-    e->alen = 0;
-    e->acap = cap;
+    e->arr = cap > 0 ? phot_arr_realloc(NULL, cap) : NULL;
+    e->len = 0;
     e->type = PHOT_ARR;
+    return true;
 }
 
 size_t phot_get_arr_len(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    return e->alen;
+    phot_lazy_load(e);
+    return e->len;
 }
 
 size_t phot_get_arr_cap(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    return e->acap;
+    phot_lazy_load(e);
+    return phot_arr_cap(e);
 }
 
-void phot_reserve_arr(phot_elem *e, size_t cap)
+bool phot_reserve_arr(phot_elem *e, size_t cap)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    if (cap > e->acap) {
-        e->arr = (phot_elem *)realloc(e->arr, cap * sizeof(phot_elem));
-        e->acap = cap;
+    if (UNLIKELY(!phot_len_fits(cap))) return false;
+    phot_lazy_load(e);
+    if (cap > phot_arr_cap(e)) {
+        if (e->flags & PHOT_FLAG_BORROWED) {
+            // 借用的缓冲区无法 realloc，先搬到堆上
+            phot_elem *arr = phot_arr_realloc(NULL, cap);
+            memcpy(arr, e->arr, e->len * sizeof(phot_elem));
+            e->arr = arr;
+            e->flags &= ~PHOT_FLAG_BORROWED;
+        } else {
+            e->arr = phot_arr_realloc(e->arr, cap);
+        }
     }
+    return true;
 }
 
 void phot_shrink_arr(phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    if (e->alen < e->acap) {
-        if (e->alen == 0) {
-            phot_clear_arr(e);
+    phot_lazy_load(e);
+    if (e->len < phot_arr_cap(e)) {
+        if (e->flags & PHOT_FLAG_BORROWED) {
+            phot_arr_head_of(e)->cap = e->len;
+        } else if (e->len == 0) {
+            phot_mem_free(phot_arr_head_of(e), phot_arr_size(phot_arr_cap(e)));
+            e->arr = NULL;
         } else {
-            e->arr = (phot_elem *)realloc(e->arr, e->alen * sizeof(phot_elem));
+            e->arr = phot_arr_realloc(e->arr, e->len);
         }
-        e->acap = e->alen;
     }
 }
 
 void phot_clear_arr(phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    phot_erase_arr(e, 0, e->alen);
+    phot_lazy_load(e);
+    phot_erase_arr(e, 0, e->len);
 }
 
 phot_elem *phot_get_arr_elem(const phot_elem *e, size_t index)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    assert(index < e->alen);
+    phot_lazy_load(e);
+    assert(index < e->len);
     return &e->arr[index];
 }
 
@@ -841,124 +4939,160 @@ phot_elem *phot_get_arr_elem(const phot_elem *e, size_t index)
 phot_elem *phot_push_arr(phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_ARR);
-    if (e->alen == e->acap) {
-        phot_reserve_arr(e, e->acap == 0 ? 1 : e->acap * 2);
+    phot_lazy_load(e);
+    if (e->len == phot_arr_cap(e)) {
+        if (UNLIKELY(e->len == UINT32_MAX)) return NULL;
+        phot_reserve_arr(e, phot_grow_cap(e->len));
     }
-    phot_init(&e->arr[e->alen]);
-    return &e->arr[e->alen++];
+    phot_init(&e->arr[e->len]);
+    return &e->arr[e->len++];
 }
 
 void phot_pop_arr(phot_elem *e)
 {
-    assert(e != NULL && e->type == PHOT_ARR && e->alen > 0);
-    phot_free(&e->arr[--e->alen]);
+    assert(e != NULL && e->type == PHOT_ARR);
+    phot_lazy_load(e);
+    assert(e->len > 0);
+    phot_free(&e->arr[--e->len]);
 }
 
 phot_elem *phot_insert_arr(phot_elem *e, size_t index)
 {
-    assert(e != NULL && e->type == PHOT_ARR && index <= e->alen);
-    if (e->alen == e->acap) {
-        phot_reserve_arr(e, e->acap == 0 ? 1 : e->acap * 2);
+    assert(e != NULL && e->type == PHOT_ARR);
+    phot_lazy_load(e);
+    assert(index <= e->len);
+    if (e->len == phot_arr_cap(e)) {
+        if (UNLIKELY(e->len == UINT32_MAX)) return NULL;
+        phot_reserve_arr(e, phot_grow_cap(e->len));
     }
-    memmove(&e->arr[index + 1], &e->arr[index], (e->alen - index) * sizeof(phot_elem));
+    memmove(&e->arr[index + 1], &e->arr[index], (e->len - index) * sizeof(phot_elem));
     phot_init(&e->arr[index]);
-    e->alen++;
+    e->len++;
     return &e->arr[index];
 }
 
 void phot_erase_arr(phot_elem *e, size_t index, size_t count)
 {
-    assert(e != NULL && e->type == PHOT_ARR && index + count <= e->alen);
+    assert(e != NULL && e->type == PHOT_ARR);
+    phot_lazy_load(e);
+    assert(index + count <= e->len);
     for (size_t i = index; i < index + count; i++) {
         phot_free(&e->arr[i]);
     }
-    memmove(&e->arr[index], &e->arr[index + count], (e->alen - index - count) * sizeof(phot_elem));
-    for (size_t i = e->alen - count; i < e->alen; i++) {
+    memmove(&e->arr[index], &e->arr[index + count], (e->len - index - count) * sizeof(phot_elem));
+    for (size_t i = e->len - count; i < e->len; i++) {
         phot_init(&e->arr[i]);
     }
-    e->alen -= count;
+    e->len -= count;
 }
 
-void phot_set_obj(phot_elem *e, size_t cap)
+bool phot_set_obj(phot_elem *e, size_t cap)
 {
     assert(e != NULL);
+    if (UNLIKELY(!phot_len_fits(cap))) return false;
     phot_free(e);
-    e->obj = cap > 0 ? (phot_member *)malloc(cap * sizeof(phot_member)) : NULL;
-    e->olen = 0;
-    e->ocap = cap;
+    e->obj = cap > 0 ? phot_obj_realloc(NULL, cap) : NULL;
+    e->len = 0;
     e->type = PHOT_OBJ;
+    return true;
 }
 
 size_t phot_get_obj_len(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    return e->olen;
+    phot_lazy_load(e);
+    return e->len;
 }
 
 size_t phot_get_obj_cap(const phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    return e->ocap;
+    phot_lazy_load(e);
+    return phot_obj_cap(e);
 }
 
-void phot_reserve_obj(phot_elem *e, size_t cap)
+bool phot_reserve_obj(phot_elem *e, size_t cap)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    if (cap > e->ocap) {
-        e->obj = (phot_member *)realloc(e->obj, cap * sizeof(phot_member));
-        e->ocap = cap;
+    if (UNLIKELY(!phot_len_fits(cap))) return false;
+    phot_lazy_load(e);
+    if (cap > phot_obj_cap(e)) {
+        if (e->flags & PHOT_FLAG_BORROWED) {
+            phot_member *obj = phot_obj_realloc(NULL, cap);
+            memcpy(obj, e->obj, e->len * sizeof(phot_member));
+            e->obj = obj;
+            e->flags &= ~PHOT_FLAG_BORROWED;
+            phot_obj_index_build(e);
+        } else {
+            e->obj = phot_obj_realloc(e->obj, cap);
+        }
     }
+    return true;
 }
 
 void phot_shrink_obj(phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    if (e->olen < e->ocap) {
-        if (e->olen == 0) {
+    phot_lazy_load(e);
+    if (e->len < phot_obj_cap(e)) {
+        if (e->flags & PHOT_FLAG_BORROWED) {
+            phot_obj_head_of(e)->cap = e->len;
+        } else if (e->len == 0) {
             phot_clear_obj(e);
+            phot_mem_free(phot_obj_head_of(e), phot_obj_size(phot_obj_cap(e)));
+            e->obj = NULL;
         } else {
-            e->obj = (phot_member *)realloc(e->obj, e->olen * sizeof(phot_member));
+            e->obj = phot_obj_realloc(e->obj, e->len);
         }
-        e->ocap = e->olen;
     }
 }
 
 void phot_clear_obj(phot_elem *e)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    for (size_t i = 0; i < e->olen; i++) {
-        free(e->obj[i].key);
+    phot_lazy_load(e);
+    for (size_t i = 0; i < e->len; i++) {
+        phot_free(&e->obj[i].key);
         phot_free(&e->obj[i].value);
     }
-    e->olen = 0;
+    phot_obj_index_drop(e);
+    e->len = 0;
 }
 
 const char *phot_get_obj_key(const phot_elem *e, size_t index)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    assert(index < e->olen);
-    return e->obj[index].key;
+    phot_lazy_load(e);
+    assert(index < e->len);
+    return phot_str_ptr(&e->obj[index].key);
 }
 
 size_t phot_get_obj_key_len(const phot_elem *e, size_t index)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    assert(index < e->olen);
-    return e->obj[index].klen;
+    phot_lazy_load(e);
+    assert(index < e->len);
+    return phot_str_len(&e->obj[index].key);
 }
 
 phot_elem *phot_get_obj_value(const phot_elem *e, size_t index)
 {
     assert(e != NULL && e->type == PHOT_OBJ);
-    assert(index < e->olen);
+    phot_lazy_load(e);
+    assert(index < e->len);
     return &e->obj[index].value;
 }
 
 size_t phot_find_obj_index(const phot_elem *e, const char *key, size_t klen)
 {
     assert(e != NULL && e->type == PHOT_OBJ && key != NULL);
-    for (size_t i = 0; i < e->olen; i++) {
-        if (e->obj[i].klen == klen && memcmp(e->obj[i].key, key, klen) == 0) {
+    phot_lazy_load(e);
+    phot_obj_index *index = phot_obj_get_index(e);
+    if (index != NULL) {
+        return phot_obj_index_find(index, e->obj, key, klen);
+    }
+    for (size_t i = 0; i < e->len; i++) {
+        if (phot_key_eq(&e->obj[i].key, key, klen)) {
             return i;
         }
     }
@@ -968,35 +5102,57 @@ size_t phot_find_obj_index(const phot_elem *e, const char *key, size_t klen)
 phot_elem *phot_find_obj_value(const phot_elem *e, const char *key, size_t klen)
 {
     assert(e != NULL && e->type == PHOT_OBJ && key != NULL);
+    phot_lazy_load(e);
     size_t index = phot_find_obj_index(e, key, klen);
     return index == PHOT_KEY_NOT_EXIST ? NULL : &e->obj[index].value;
 }
 
 phot_elem *phot_set_obj_value(phot_elem *e, const char *key, size_t klen)
+{
+    return phot_set_obj_value_intern(e, key, klen, NULL);
+}
+
+phot_elem *phot_set_obj_value_intern(phot_elem *e, const char *key, size_t klen, phot_intern *keys)
 {
     assert(e != NULL && e->type == PHOT_OBJ && key != NULL);
+    phot_lazy_load(e);
+    if (UNLIKELY(!phot_len_fits(klen))) return NULL;
     size_t index = phot_find_obj_index(e, key, klen);
     if (index == PHOT_KEY_NOT_EXIST) {
-        if (e->olen == e->ocap) {
-            phot_reserve_obj(e, e->ocap == 0 ? 1 : e->ocap * 2);
-        }
-        index = e->olen++;
-        e->obj[index].key = (char *)malloc(klen + 1);
-        memcpy(e->obj[index].key, key, klen);
-        e->obj[index].key[klen] = '\0';
-        e->obj[index].klen = klen;
+        if (UNLIKELY(e->len == UINT32_MAX)) return NULL;
+        // key 可能是本对象里某个短字符串值，扩容会移动它，先复制出来
+        phot_elem k;
+        const char *shared = keys != NULL && klen > PHOT_SSO_MAX ? phot_intern_key(keys, key, klen) : NULL;
+        if (shared != NULL) {
+            phot_str_borrow(&k, shared, klen);
+        } else {
+            phot_str_init(&k, key, klen);
+        }
+        if (e->len == phot_obj_cap(e)) {
+            phot_reserve_obj(e, phot_grow_cap(e->len));
+        }
+        index = e->len++;
+        memcpy(&e->obj[index].key, &k, sizeof(phot_elem));
         phot_init(&e->obj[index].value);
+        phot_obj_index_append(e);
     }
     return &e->obj[index].value;
 }
 
 void phot_remove_obj_member(phot_elem *e, size_t index)
 {
-    assert(e != NULL && e->type == PHOT_OBJ && index < e->olen);
-    free(e->obj[index].key);
+    assert(e != NULL && e->type == PHOT_OBJ);
+    phot_lazy_load(e);
+    assert(index < e->len);
+    phot_free(&e->obj[index].key);
     phot_free(&e->obj[index].value);
-    if (index < e->olen - 1) {
-        memmove(&e->obj[index], &e->obj[index + 1], (e->olen - index - 1) * sizeof(phot_member));
+    if (index < e->len - 1) {
+        memmove(&e->obj[index], &e->obj[index + 1], (e->len - index - 1) * sizeof(phot_member));
+    }
+    e->len--;
+    // 后面的成员下标都变了，在原来的槽里重新填充，成员变少后负载因子不会超出
+    phot_obj_index *oi = *phot_obj_index_of(e);
+    if (oi != NULL) {
+        phot_obj_index_fill(oi, oi->mask + 1, e->obj, e->len);
     }
-    e->olen--;
 }
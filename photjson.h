@@ -2,41 +2,148 @@
 #define PHOTJSON_H_
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #define PHOT_KEY_NOT_EXIST ((size_t) - 1)
 
 typedef enum { PHOT_NULL, PHOT_BOOL, PHOT_NUM, PHOT_STR, PHOT_ARR, PHOT_OBJ } phot_type;
 typedef struct phot_elem phot_elem;
 typedef struct phot_member phot_member;
+typedef struct phot_chunk phot_chunk;
+typedef struct phot_doc phot_doc;
+typedef struct phot_intern phot_intern;
 
+// 分配器，ctx 原样传给各个函数；不会收到空指针，从空指针开始的 realloc 改为调用 alloc
+// realloc 的 old_size 和 free 的 size 为此前请求的字节数，交还给调用者后又交回来的内存为 0，表示未知
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} phot_allocator;
+
+// 元素在 64 位平台上占 16 字节：载荷、32 位的长度、短字符串的两个字节和两个字节的标记
+// 数组和对象的容量保存在缓冲区之前的头部，所以字符串长度、元素个数和成员个数都不能超过 UINT32_MAX
+// 不超过 12 字节的字符串带 PHOT_FLAG_INLINE，从元素的开头起存放，覆盖载荷、len 和 sso_tail
 struct phot_elem {
     union {
         bool boolean;
         double num;
-        struct {
-            char *str;    // 字符串
-            size_t slen;  // 长度
-        };
-        struct {
-            phot_elem *arr;  // 数组
-            size_t acap;     // 容量
-            size_t alen;     // 元素个数
-        };  // 数组里保存的叫元素
-        struct {
-            phot_member *obj;  // 对象
-            size_t ocap;       // 容量
-            size_t olen;       // 成员个数
-        };  // 对象里保存的叫成员
+        char *str;         // 字符串
+        phot_elem *arr;    // 数组，数组里保存的叫元素
+        phot_member *obj;  // 对象，对象里保存的叫成员
+        phot_doc *ldoc;    // 惰性元素所在的文档，带 PHOT_FLAG_LAZY 时有效
     };
-    phot_type type;
+    uint32_t len;           // 字符串长度、元素个数或成员个数；惰性元素为原文相对于 ldoc->src 的偏移
+    char sso_tail;          // 短字符串占用的第 13 个字节
+    unsigned char sso_len;  // 短字符串的长度
+    unsigned char type;     // phot_type
+    unsigned char flags;    // 所有权标记
+};
+
+// 借用的内存不归元素所有，phot_free 时不会释放
+enum {
+    PHOT_FLAG_BORROWED = 1 << 0,  // 字符串、数组或对象的缓冲区是借用的
+    PHOT_FLAG_INLINE = 1 << 1,    // 短字符串存放在元素内
+    PHOT_FLAG_LAZY = 1 << 2,      // 值尚未解码，第一次访问时就地展开
+    PHOT_FLAG_INVALID = 1 << 3,   // 惰性解码失败，值为同类型的零值，错误码见 phot_get_status
 };
 
 struct phot_member {
-    char *key;
+    phot_elem key;  // 键是字符串元素，所有权和短字符串的存放方式与值相同
     phot_elem value;
-    size_t klen;
 };  // 成员本身是键值对
 
+// 文档持有一个 arena，解析出的所有节点、键和字符串都分配在其中，整体释放
+struct phot_doc {
+    phot_elem root;               // 根元素
+    phot_chunk *head;             // 内存块链表
+    phot_chunk *cur;              // 当前分配所在的块
+    size_t used;                  // 当前块已用的字节数
+    char *stack;                  // 复用的解析栈
+    size_t size;                  // 解析栈的容量
+    int status;                   // 惰性解码时遇到的第一个错误
+    const char *src;              // 惰性解析借用的原文
+    const char *end;              // 原文的结尾
+    phot_intern *keys;            // 键的驻留表，phot_doc_init 之后设置，为 NULL 时不驻留
+    const phot_allocator *alloc;  // arena 和解析栈的分配器，phot_doc_init 之后、第一次解析前设置，为 NULL 时使用全局的分配器
+};
+
+// 驻留表的统计，只统计放不进元素、需要单独保存的长键
+typedef struct {
+    size_t keys;     // 表中的键数
+    size_t bytes;    // 表中键的字节数，含结尾的 '\0'
+    size_t lookups;  // 查询次数
+    size_t hits;     // 命中次数
+    size_t saved;    // 命中时省下的分配字节数
+} phot_intern_stats;
+
+// 只读载入内存的文件，普通文件通过 mmap 映射，其它文件读入堆内存
+typedef struct {
+    const char *data;  // 文件内容，不以 '\0' 结尾
+    size_t len;        // 文件长度
+    bool mapped;       // data 是否为映射得到的
+} phot_file_map;
+
+// NDJSON 每条记录的回调，offset 为记录在输入中的字节偏移，status 为该记录的解析结果
+// e 分配在工作线程的 arena 中，只在回调期间有效，需要保留时用 phot_copy 复制；返回 false 时中止
+typedef bool (*phot_ndjson_cb)(void *ud, size_t offset, int status, const phot_elem *e);
+
+// 流式序列化的输出回调，写出 buf 的 len 个字节，失败时返回 false
+typedef bool (*phot_write_cb)(void *ud, const char *buf, size_t len);
+
+// 序列化的格式，全零时输出与 phot_stringify 相同的紧凑 JSON
+typedef struct {
+    unsigned indent;         // 每层缩进的字符数，为 0 时不换行
+    char indent_char;        // 缩进字符，只能是 ' ' 或 '\t'，为 '\0' 时使用空格
+    bool crlf;               // 换行使用 "\r\n"，否则使用 "\n"
+    bool space_after_colon;  // 对象的 ':' 之后加一个空格
+} phot_stringify_opts;
+
+typedef struct {
+    size_t threads;               // 线程数，为 0 时使用全部在线的 CPU
+    bool ordered;                 // 为 true 时按输入顺序逐条回调，否则各线程并发回调，回调需自行保证线程安全
+    phot_intern *keys;            // 非空时各线程解析出的长键共享这个驻留表
+    const phot_allocator *alloc;  // 非空时各线程的文档和批次缓冲区使用这个分配器，需要线程安全
+} phot_ndjson_opts;
+
+// 可复用的解析器，解析栈在多次调用之间保留，避免每次解析都重新分配和增长；不能多线程共享
+typedef struct {
+    char *stack;        // 复用的解析栈
+    size_t size;        // 解析栈的容量
+    size_t trim;        // 每次解析后容量超过它时缩回到它，为 0 时一直保留，phot_parser_init 之后设置
+    phot_intern *keys;  // 非空时长键从这个驻留表共享，见 phot_parse_intern
+} phot_parser;
+
+// 可复用的序列化器，输出缓冲区在多次调用之间保留；不能多线程共享
+typedef struct {
+    char *buf;    // 复用的输出缓冲区，存放最近一次的输出
+    size_t size;  // 输出缓冲区的容量
+    size_t trim;  // 每次序列化前容量超过它时缩回到它，为 0 时一直保留，phot_writer_init 之后设置
+} phot_writer;
+
+// 一次解析的统计，见 phot_get_parse_stats
+typedef struct {
+    size_t bytes;                 // 消耗的输入字节数，出错时为出错的位置
+    size_t values[PHOT_OBJ + 1];  // 各类型值的个数，以 phot_type 为下标
+    size_t keys;                  // 对象的键数
+    size_t max_depth;             // 数组和对象的最大嵌套深度
+    size_t strs_fast;             // 不含转义、整段扫描得到的字符串和键
+    size_t strs_escaped;          // 含有转义、逐字符解码的字符串和键
+    size_t stack_peak;            // 解析栈的最大容量，单位为字节
+    size_t stack_reallocs;        // 解析栈的扩容次数
+    size_t allocs;                // 分配次数，包括 realloc
+    double index_seconds;         // 建立结构索引的时间，只在生效的实现为 PHOT_BACKEND_INDEX 时非零
+    double parse_seconds;         // 其余的解析和建树时间
+} phot_parse_stats;
+
+// 热点循环可以使用的指令集，按从低到高排列
+typedef enum { PHOT_SIMD_SCALAR, PHOT_SIMD_SWAR, PHOT_SIMD_SSE2, PHOT_SIMD_SSE42, PHOT_SIMD_AVX2 } phot_simd;
+
+// 解析器的实现：逐字节识别结构的单遍解析，或先用 SIMD 建立结构索引的两阶段解析（实验性，见 phot_set_backend）
+typedef enum { PHOT_BACKEND_DESCENT, PHOT_BACKEND_INDEX } phot_backend;
+
 // enum 会自动声明为连续的常量，故在 C 中常用这种方式来声明一组常量
 enum {
     PHOT_PARSE_OK = 0,
@@ -53,13 +160,48 @@ enum {
     PHOT_PARSE_MISS_KEY,
     PHOT_PARSE_MISS_COLON,
     PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+    PHOT_PARSE_ABORTED,     // 处理器中止了解析
+    PHOT_PARSE_FILE_ERROR,  // 无法打开或读取文件
+    PHOT_PARSE_TOO_DEEP,    // 数组和对象的嵌套超过了最大深度
+    PHOT_PARSE_TOO_LONG,    // 字符串长度、数组元素个数或对象成员个数超过了 UINT32_MAX
 };
 
+// SAX 事件处理器，ud 是调用 phot_parse_sax 时传入的用户数据
+// 回调返回 false 时中止解析，不关心的事件可以把回调设为 NULL
+// 字符串和键只在回调期间有效，且不保证以 '\0' 结尾
+typedef struct {
+    bool (*null)(void *ud);
+    bool (*boolean)(void *ud, bool boolean);
+    bool (*num)(void *ud, double num);
+    bool (*str)(void *ud, const char *str, size_t len);
+    bool (*start_arr)(void *ud);
+    bool (*end_arr)(void *ud, size_t count);  // count 为数组的元素个数
+    bool (*start_obj)(void *ud);
+    bool (*key)(void *ud, const char *key, size_t klen);
+    bool (*end_obj)(void *ud, size_t count);  // count 为对象的成员个数
+} phot_handler;
+
+// 增量解析器，输入可以分成任意多块依次送入，解析状态跨块保存
+// 内部占用的内存只与嵌套深度和最长的单个 token 成正比（构建 DOM 时还要加上 DOM 本身）
+typedef struct {
+    const phot_handler *handler;  // 事件处理器
+    void *ud;                     // 传给处理器的用户数据
+    phot_elem *root;              // 构建 DOM 时结果的存放位置，否则为 NULL
+    char *stack;                  // 解析栈
+    size_t size, top;
+    size_t *nest;  // 每层未闭合容器的成员个数左移一位，最低位为 1 表示对象
+    size_t depth, ncap;
+    char *token;  // 跨块的未完成 token
+    size_t tlen, tcap;
+    int state;   // 下一个字节的语法状态
+    int status;  // 出错后保持为错误码
+} phot_stream;
+
 /**
- * @brief 初始化元素，即将其类型设为 PHOT_NULL
+ * @brief 初始化元素，即将其类型设为 PHOT_NULL 并清除所有权标记
  * @param e 待初始化的元素
  */
-#define phot_init(e) (e)->type = PHOT_NULL
+#define phot_init(e) ((e)->type = PHOT_NULL, (e)->flags = 0)
 
 /**
  * @brief 将 JSON 文本解析为元素
@@ -68,6 +210,71 @@ enum {
  * @return 解析出的枚举值
  */
 int phot_parse(phot_elem *e, const char *json);
+/**
+ * @brief 解析恰好 len 字节的 JSON 文本，不要求以 '\0' 结尾
+ * @note 可以直接解析网络缓冲区或大文件的一个片段；其中的 '\0' 字节按普通的非法字符处理
+ * @param e 待解析的元素
+ * @param json JSON 文本
+ * @param len json 的字节数
+ * @return 解析出的枚举值
+ */
+int phot_parse_n(phot_elem *e, const char *json, size_t len);
+/**
+ * @brief 同 phot_parse_n，但超过 12 字节的键从驻留表 keys 中取共享的只读副本，不再逐个分配
+ * @note 元素借用这些键，keys 须在元素释放前保持有效；phot_copy 得到的副本自己持有键
+ * @param e 待解析的元素
+ * @param json JSON 文本
+ * @param len json 的字节数
+ * @param keys 驻留表，为 NULL 时等同于 phot_parse_n
+ * @return 解析出的枚举值
+ */
+int phot_parse_intern(phot_elem *e, const char *json, size_t len, phot_intern *keys);
+/**
+ * @brief 原地解析 JSON 文本，字符串和键直接解码在 json 中，元素借用这些内存
+ * @note json 会被改写，且在元素释放前必须保持有效
+ * @param e 待解析的元素
+ * @param json 可写的 JSON 文本
+ * @return 解析出的枚举值
+ */
+int phot_parse_insitu(phot_elem *e, char *json);
+/**
+ * @brief 以事件流的方式解析 JSON 文本，不构建元素树
+ * @note 事件按文本顺序发出，出错前已发出的事件不会撤回
+ * @param json JSON 文本
+ * @param handler 事件处理器
+ * @param ud 传给回调的用户数据
+ * @return 解析出的枚举值，处理器中止时为 PHOT_PARSE_ABORTED
+ */
+int phot_parse_sax(const char *json, const phot_handler *handler, void *ud);
+/**
+ * @brief 初始化增量解析器，解析结果构建为 DOM 存放在 e 中
+ * @param s 增量解析器
+ * @param e 存放解析结果的元素，在 phot_stream_finish 成功返回后才可用
+ */
+void phot_stream_init(phot_stream *s, phot_elem *e);
+/**
+ * @brief 初始化增量解析器，解析时向 handler 发出事件
+ * @param s 增量解析器
+ * @param handler 事件处理器
+ * @param ud 传给回调的用户数据
+ */
+void phot_stream_init_sax(phot_stream *s, const phot_handler *handler, void *ud);
+/**
+ * @brief 送入下一块输入，分块的位置可以是任意的，包括字符串、转义序列或数字的中间
+ * @note 输入中不应出现 '\0'；出错后再送入的数据会被忽略
+ * @param s 增量解析器
+ * @param buf 输入块
+ * @param len 输入块的长度
+ * @return 到目前为止的解析结果，PHOT_PARSE_OK 表示尚未出错
+ */
+int phot_stream_feed(phot_stream *s, const char *buf, size_t len);
+/**
+ * @brief 结束输入，完成解析并释放解析器内部的缓冲区
+ * @note 无论之前是否出错都必须调用；返回值与对整个输入调用 phot_parse 的结果相同
+ * @param s 增量解析器
+ * @return 解析出的枚举值
+ */
+int phot_stream_finish(phot_stream *s);
 /**
  * @brief 将元素序列化为 JSON 文本
  * @param e 待序列化的元素
@@ -75,12 +282,124 @@ int phot_parse(phot_elem *e, const char *json);
  * @return JSON 文本
  */
 char *phot_stringify(const phot_elem *e, size_t *length);
+/**
+ * @brief 流式序列化：输出先写入固定大小的缓冲区，每积满一次就交给 write，内存占用与树的大小无关
+ * @note 回调失败后不再调用，序列化照常走完但输出被丢弃
+ * @param e 待序列化的元素
+ * @param write 输出回调
+ * @param ud 传给回调的用户数据
+ * @return 成功时返回 0，回调失败过时返回 -1
+ */
+int phot_stringify_to(const phot_elem *e, phot_write_cb write, void *ud);
+/**
+ * @brief 流式序列化到 FILE*，不会关闭或刷新 fp
+ * @param e 待序列化的元素
+ * @param fp 已打开的文件
+ * @return 成功时返回 0，写入失败时返回 -1
+ */
+int phot_stringify_fp(const phot_elem *e, FILE *fp);
+/**
+ * @brief 流式序列化到文件描述符，自动重试部分写入和被信号打断的写入
+ * @note 需要 POSIX 的 write，不可用时总是返回 -1
+ * @param e 待序列化的元素
+ * @param fd 文件描述符
+ * @return 成功时返回 0，写入失败时返回 -1
+ */
+int phot_stringify_fd(const phot_elem *e, int fd);
+/**
+ * @brief 按指定格式将元素序列化为 JSON 文本，空数组和空对象仍输出为 [] 和 {}
+ * @param e 待序列化的元素
+ * @param opts 格式，为 NULL 时与 phot_stringify 相同
+ * @param length JSON 文本的长度
+ * @return JSON 文本
+ */
+char *phot_stringify_ex(const phot_elem *e, const phot_stringify_opts *opts, size_t *length);
+/**
+ * @brief 按指定格式流式序列化，见 phot_stringify_to
+ * @param e 待序列化的元素
+ * @param opts 格式，为 NULL 时与 phot_stringify_to 相同
+ * @param write 输出回调
+ * @param ud 传给回调的用户数据
+ * @return 成功时返回 0，回调失败过时返回 -1
+ */
+int phot_stringify_to_ex(const phot_elem *e, const phot_stringify_opts *opts, phot_write_cb write, void *ud);
+/**
+ * @brief 初始化可复用的解析器，此时不持有任何内存
+ * @param p 待初始化的解析器
+ */
+void phot_parser_init(phot_parser *p);
+/**
+ * @brief 使用解析器的解析栈解析恰好 len 字节的 JSON 文本，结果与 phot_parse_intern(e, json, len, p->keys) 相同
+ * @note 解析出的元素不依赖解析器，解析器可以先于元素释放
+ * @param p 解析器
+ * @param e 待解析的元素
+ * @param json JSON 文本
+ * @param len json 的字节数
+ * @return 解析出的枚举值
+ */
+int phot_parse_with(phot_parser *p, phot_elem *e, const char *json, size_t len);
+/**
+ * @brief 释放解析器持有的解析栈
+ * @param p 解析器
+ */
+void phot_parser_free(phot_parser *p);
+/**
+ * @brief 初始化可复用的序列化器，此时不持有任何内存
+ * @param w 待初始化的序列化器
+ */
+void phot_writer_init(phot_writer *w);
+/**
+ * @brief 使用序列化器的缓冲区按指定格式序列化元素，见 phot_stringify_ex
+ * @note 返回的文本属于序列化器，不能释放，在下一次调用或 phot_writer_free 之前有效
+ * @param w 序列化器
+ * @param e 待序列化的元素
+ * @param opts 格式，为 NULL 时输出紧凑的 JSON
+ * @param length JSON 文本的长度
+ * @return 以 '\0' 结尾的 JSON 文本
+ */
+const char *phot_stringify_with(phot_writer *w, const phot_elem *e, const phot_stringify_opts *opts, size_t *length);
+/**
+ * @brief 释放序列化器持有的缓冲区
+ * @param w 序列化器
+ */
+void phot_writer_free(phot_writer *w);
 /**
  * @brief 将 JSON 文件读取为元素
  * @param filename 文件名
  * @return 读取到的元素
  */
 phot_elem *phot_read_from_file(const char *filename);
+/**
+ * @brief 解析 JSON 文件，普通文件会被映射到内存中按长度解析，管道等其它文件分块读入
+ * @param e 待解析的元素
+ * @param filename 文件名
+ * @return 解析出的枚举值，无法打开或读取文件时为 PHOT_PARSE_FILE_ERROR
+ */
+int phot_parse_file(phot_elem *e, const char *filename);
+/**
+ * @brief 将文件只读载入内存，可以交给 phot_parse_n 或 phot_stream_feed 解析而不必复制
+ * @param m 载入的文件
+ * @param filename 文件名
+ * @return 成功时为 0，失败时为 -1
+ */
+int phot_map_file(phot_file_map *m, const char *filename);
+/**
+ * @brief 释放 phot_map_file 载入的文件
+ * @param m 载入的文件
+ */
+void phot_unmap_file(phot_file_map *m);
+/**
+ * @brief 多线程解析 NDJSON，即每行一个 JSON 文本，空白行被忽略
+ * @note 单条记录出错不影响其它记录；中止后不再开始新的批次，无序回调时已在处理的批次可能还会回调
+ *       大文件可以先用 phot_map_file 载入
+ * @param buf NDJSON 文本，不要求以 '\0' 结尾
+ * @param len buf 的字节数
+ * @param opts 线程数和交付顺序，为 NULL 时使用全部 CPU 并按顺序交付
+ * @param cb 每条记录的回调
+ * @param ud 传给回调的用户数据
+ * @return 全部交付完为 PHOT_PARSE_OK，回调中止时为 PHOT_PARSE_ABORTED
+ */
+int phot_parse_ndjson(const char *buf, size_t len, const phot_ndjson_opts *opts, phot_ndjson_cb cb, void *ud);
 /**
  * @brief 将元素保存至 JSON 文件
  * @param e 待写入的元素
@@ -89,6 +408,143 @@ phot_elem *phot_read_from_file(const char *filename);
  */
 int phot_write_to_file(const phot_elem *e, const char *filename);
 
+/**
+ * @brief 初始化文档，此时不持有任何内存
+ * @param doc 待初始化的文档
+ */
+void phot_doc_init(phot_doc *doc);
+/**
+ * @brief 将 JSON 文本解析到文档中，所有内存都从文档的 arena 分配
+ * @note 会先重置文档，此前从该文档解析出的元素全部失效
+ * @param doc 目标文档
+ * @param json JSON 文本
+ * @return 解析出的枚举值
+ */
+int phot_parse_doc(phot_doc *doc, const char *json);
+/**
+ * @brief 获取文档的根元素
+ * @param doc 目标文档
+ * @return 根元素
+ */
+#define phot_doc_root(doc) (&(doc)->root)
+/**
+ * @brief 惰性地将 JSON 文本解析到文档中，只检查括号是否配对，字符串、数字、数组和对象都在第一次访问时才解码
+ * @note 会先重置文档；文档借用 json 而不复制，json 须在文档重置或释放前保持有效
+ * @note 访问元素的函数照常使用，数组和对象每次只展开一层，没有访问过的子树只被跳过一次
+ * @note 读取也会修改文档，所以即便只读也不能多线程共享；解码时的错误记录在 phot_doc_status 中，
+ *       出错的元素可以在访问时用 phot_get_status 检查
+ * @note 文本超过 UINT32_MAX 字节时退化为 phot_parse_doc
+ * @param doc 目标文档
+ * @param json JSON 文本，不要求以 '\0' 结尾
+ * @param len 文本长度
+ * @return 解析出的枚举值，出错时与 phot_parse_doc 的结果相同
+ */
+int phot_parse_lazy(phot_doc *doc, const char *json, size_t len);
+/**
+ * @brief 获取惰性解码时遇到的第一个错误，出错的值表现为 0、空字符串、空数组或空对象
+ * @note 只反映已经访问过的值；要知道某个值本身是否有效，用 phot_get_status
+ * @param doc 目标文档
+ * @return 解析出的枚举值
+ */
+#define phot_doc_status(doc) ((doc)->status)
+/**
+ * @brief 重置文档，保留已分配的内存块供下次解析复用
+ * @note 若修改过文档树并写入了堆上的值，需先对根元素调用 phot_free
+ * @param doc 目标文档
+ */
+void phot_doc_reset(phot_doc *doc);
+/**
+ * @brief 释放文档持有的全部内存
+ * @param doc 目标文档
+ */
+void phot_doc_free(phot_doc *doc);
+
+/**
+ * @brief 创建键的驻留表，相同的键共享同一份只读的缓冲区，可以被多个线程同时使用
+ * @note 表满之后不再插入新键，未命中的键照常分配
+ * @param max_keys 最多容纳的键数，为 0 时使用 PHOT_INTERN_MAX_KEYS
+ * @return 新的驻留表
+ */
+phot_intern *phot_intern_new(size_t max_keys);
+/**
+ * @brief 释放驻留表，借用其中键的元素和文档都必须先释放
+ * @param t 驻留表，可以为 NULL
+ */
+void phot_intern_free(phot_intern *t);
+/**
+ * @brief 查找或插入一个键，返回共享的副本
+ * @note 用返回的指针调用 phot_find_obj_index 时，对驻留过的键只比较地址
+ * @param t 驻留表
+ * @param key 键
+ * @param klen 键长度
+ * @return 以 '\0' 结尾的共享副本，表满或 klen 超过 UINT32_MAX 时返回 NULL
+ */
+const char *phot_intern_key(phot_intern *t, const char *key, size_t klen);
+/**
+ * @brief 获取驻留表的统计，命中率为 hits / lookups
+ * @param t 驻留表
+ * @param stats 统计结果
+ */
+void phot_intern_get_stats(phot_intern *t, phot_intern_stats *stats);
+
+/**
+ * @brief 选择热点循环使用的指令集，默认使用 CPU 支持的最高级别
+ * @note 不是线程安全的，应在解析开始前调用
+ * @param simd 期望的指令集
+ * @return 实际生效的指令集，不会超过 CPU 支持的级别
+ */
+phot_simd phot_set_simd(phot_simd simd);
+/**
+ * @brief 获取热点循环当前使用的指令集
+ * @return 当前的指令集
+ */
+phot_simd phot_get_simd(void);
+/**
+ * @brief 选择 phot_parse、phot_parse_n、phot_parse_doc 和 phot_parse_sax 使用的解析器实现
+ * @note 两种实现得到的元素和错误码完全相同；原地解析和增量解析总是逐字节识别结构；不是线程安全的，应在解析开始前调用
+ * @note PHOT_BACKEND_INDEX 是实验性的，目前比逐字节识别结构的解析慢，只有以 PHOT_USE_INDEX_BACKEND=1 编译库时才可用，
+ *       否则仍使用 PHOT_BACKEND_DESCENT
+ * @param backend 解析器的实现
+ * @return 生效的实现
+ */
+phot_backend phot_set_backend(phot_backend backend);
+/**
+ * @brief 获取当前的解析器实现
+ * @return 当前的实现
+ */
+phot_backend phot_get_backend(void);
+/**
+ * @brief 设置解析允许的最大嵌套深度，最外层的数组或对象深度为 1，超过时返回 PHOT_PARSE_TOO_DEEP
+ * @note 默认为 PHOT_PARSE_MAX_DEPTH（1024）；解析、释放、复制、比较和序列化都不递归，深度不受 C 栈的限制；
+ *       惰性文档只检查括号是否配对，不检查深度；不是线程安全的，应在解析开始前调用
+ * @param depth 最大深度，为 0 时不限制
+ */
+void phot_set_max_depth(size_t depth);
+/**
+ * @brief 获取解析允许的最大嵌套深度
+ * @return 当前的最大深度，不限制时为 0
+ */
+size_t phot_get_max_depth(void);
+/**
+ * @brief 设置全局的分配器，堆上的元素、解析栈、序列化的输出和没有指定分配器的文档都使用它
+ * @note 不是线程安全的，应在分配任何内存之前调用，之前分配的内存仍须由原来的分配器释放；
+ *       phot_stringify 的结果和 phot_read_from_file 返回的元素须用这个分配器释放，size 可传 0
+ * @param alloc 分配器，会被复制；为 NULL 时恢复为 malloc、realloc 和 free
+ */
+void phot_set_allocator(const phot_allocator *alloc);
+/**
+ * @brief 获取全局的分配器
+ * @return 当前的分配器
+ */
+const phot_allocator *phot_get_allocator(void);
+/**
+ * @brief 获取当前线程最近一次解析的统计
+ * @note 需要以 PHOT_USE_STATS=1 编译库，否则总是返回 false；惰性文档和增量解析不记录
+ * @param stats 统计结果，未编译统计时清零
+ * @return 是否编译了统计
+ */
+bool phot_get_parse_stats(phot_parse_stats *stats);
+
 /**
  * @brief 复制元素，即深拷贝
  * @param dst 目标元素
@@ -120,6 +576,14 @@ void phot_free(phot_elem *e);
  * @return 元素类型
  */
 phot_type phot_get_type(const phot_elem *e);
+/**
+ * @brief 展开惰性元素并获取它的解码结果
+ * @note phot_parse_lazy 返回 PHOT_PARSE_OK 后值仍可能在第一次访问时解码失败，失败的值表现为 0、空字符串、空数组或空对象；
+ *       读取前用本函数检查即可在访问处发现错误。数组和对象每次只展开一层，子元素需分别检查
+ * @param e 元素
+ * @return 解析出的枚举值，不是惰性解析得到的元素总是 PHOT_PARSE_OK
+ */
+int phot_get_status(const phot_elem *e);
 /**
  * @brief 判断两个元素是否相等
  * @param lhs 左元素
@@ -165,12 +629,14 @@ double phot_get_num(const phot_elem *e);
  * @param e 待设置的元素
  * @param str 字符串
  * @param len 长度
+ * @return 成功返回 true，len 超过 UINT32_MAX 时返回 false 且不修改元素
  */
-void phot_set_str(phot_elem *e, const char *str, size_t len);
+bool phot_set_str(phot_elem *e, const char *str, size_t len);
 /**
  * @brief 获取字符串元素的值
  * @param e 目标元素
- * @return 字符串
+ * @return 以 '\0' 结尾的字符串
+ * @note 短字符串存放在元素内，元素被移动（如所在的数组扩容）或修改后指针失效
  */
 const char *phot_get_str(const phot_elem *e);
 /**
@@ -184,8 +650,9 @@ size_t phot_get_str_len(const phot_elem *e);
  * @brief 设置数组元素的值
  * @param e 待设置的元素
  * @param cap 指定的容量
+ * @return 成功返回 true，cap 超过 UINT32_MAX 时返回 false 且不修改元素
  */
-void phot_set_arr(phot_elem *e, size_t cap);
+bool phot_set_arr(phot_elem *e, size_t cap);
 /**
  * @brief 获取数组元素的长度
  * @param e 目标元素
@@ -202,8 +669,9 @@ size_t phot_get_arr_cap(const phot_elem *e);
  * @brief 将数组元素的容量扩充至 cap
  * @param e 目标元素
  * @param cap 指定的容量
+ * @return 成功返回 true，cap 超过 UINT32_MAX 时返回 false 且不修改元素
  */
-void phot_reserve_arr(phot_elem *e, size_t cap);
+bool phot_reserve_arr(phot_elem *e, size_t cap);
 /**
  * @brief 将数组元素的容量收缩至实际长度
  * @param e 目标元素
@@ -224,7 +692,7 @@ phot_elem *phot_get_arr_elem(const phot_elem *e, size_t index);
 /**
  * @brief 在数组尾部添加一个元素，未实际写入
  * @param e 目标元素
- * @return 待添加元素的目标地址
+ * @return 待添加元素的目标地址，数组已有 UINT32_MAX 个元素时返回 NULL
  */
 phot_elem *phot_push_arr(phot_elem *e);
 /**
@@ -236,7 +704,7 @@ void phot_pop_arr(phot_elem *e);
  * @brief 在数组 index 处插入一个元素，未实际写入
  * @param e 目标元素
  * @param index 索引
- * @return 待插入元素的目标地址
+ * @return 待插入元素的目标地址，数组已有 UINT32_MAX 个元素时返回 NULL
  */
 phot_elem *phot_insert_arr(phot_elem *e, size_t index);
 /**
@@ -251,8 +719,9 @@ void phot_erase_arr(phot_elem *e, size_t index, size_t count);
  * @brief 设置对象元素的值
  * @param e 目标元素
  * @param cap 指定的容量
+ * @return 成功返回 true，cap 超过 UINT32_MAX 时返回 false 且不修改元素
  */
-void phot_set_obj(phot_elem *e, size_t cap);
+bool phot_set_obj(phot_elem *e, size_t cap);
 /**
  * @brief 获取对象元素的长度
  * @param e 目标元素
@@ -269,8 +738,9 @@ size_t phot_get_obj_cap(const phot_elem *e);
  * @brief 将对象元素的容量扩充至 cap
  * @param e 目标元素
  * @param cap 指定的容量
+ * @return 成功返回 true，cap 超过 UINT32_MAX 时返回 false 且不修改元素
  */
-void phot_reserve_obj(phot_elem *e, size_t cap);
+bool phot_reserve_obj(phot_elem *e, size_t cap);
 /**
  * @brief 将对象元素的容量收缩至实际长度
  * @param e 目标元素
@@ -285,7 +755,8 @@ void phot_clear_obj(phot_elem *e);
  * @brief 获取对象元素中 index 处的键
  * @param e 目标元素
  * @param index 索引
- * @return 取得的键
+ * @return 以 '\0' 结尾的键
+ * @note 短键存放在成员内，对象扩容或删除成员后指针失效
  */
 const char *phot_get_obj_key(const phot_elem *e, size_t index);
 /**
@@ -308,6 +779,8 @@ phot_elem *phot_get_obj_value(const phot_elem *e, size_t index);
  * @param key 键
  * @param klen 键长度
  * @return 取得的索引
+ * @note 成员数达到 PHOT_OBJ_INDEX_THRESHOLD 时使用哈希索引，索引在解析和修改对象时建立，查找只读，
+ *       多个线程可以同时查找同一棵不再修改的树（尚未展开的惰性元素除外）
  */
 size_t phot_find_obj_index(const phot_elem *e, const char *key, size_t klen);
 /**
@@ -323,9 +796,18 @@ phot_elem *phot_find_obj_value(const phot_elem *e, const char *key, size_t klen)
  * @param e 目标元素
  * @param key 键
  * @param klen 键长度
- * @return 取得的值
+ * @return 取得的值，需要添加成员而 klen 超过 UINT32_MAX 或对象已有 UINT32_MAX 个成员时返回 NULL
  */
 phot_elem *phot_set_obj_value(phot_elem *e, const char *key, size_t klen);
+/**
+ * @brief 同 phot_set_obj_value，但新插入的长键从驻留表 keys 中共享
+ * @param e 目标元素
+ * @param key 键
+ * @param klen 键长度
+ * @param keys 驻留表，须在元素释放前保持有效，为 NULL 时等同于 phot_set_obj_value
+ * @return 键对应的值
+ */
+phot_elem *phot_set_obj_value_intern(phot_elem *e, const char *key, size_t klen, phot_intern *keys);
 /**
  * @brief 移除对象元素中 index 处的成员
  * @param e 目标元素
@@ -1,10 +1,24 @@
+// fileno 需要 POSIX 接口
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "photjson.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define TEST_THREADS 1
+#else
+#define TEST_THREADS 0
+#endif
+
 static int main_ret = 0;
 static int test_count = 0;
 static int test_pass = 0;
@@ -98,6 +112,92 @@ static void test_parse_num(void)
     TEST_NUM(-2.2250738585072014e-308, "-2.2250738585072014e-308");
     TEST_NUM(1.7976931348623157e308, "1.7976931348623157e308");  // 最大正规数
     TEST_NUM(-1.7976931348623157e308, "-1.7976931348623157e308");
+
+    TEST_NUM(1e23, "1e23");                                          // 超出快速路径的范围
+    TEST_NUM(9007199254740992.0, "9007199254740993");                // 2^53 + 1 恰在中点上，舍入到偶数
+    TEST_NUM(9007199254740994.0, "9007199254740993.0000000000000001");  // 超过中点一点点
+    TEST_NUM(2.2250738585072011e-308, "2.2250738585072011e-308");
+    TEST_NUM(1.0, "1.00000000000000000000000000000000000000000000");  // 舍去的都是 0
+    TEST_NUM(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+    TEST_NUM(123.0, "0.00000000000000000000000000000000000000000000123e47");
+    TEST_NUM(0.0, "0e999999999999");
+}
+
+static uint64_t rand_state = 88172645463325252ULL;
+
+static uint64_t rand_u64(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+    return rand_state;
+}
+
+static double rand_double(void)
+{
+    double d;
+    do {
+        uint64_t bits = rand_u64() & 0x7FFFFFFFFFFFFFFFULL;
+        memcpy(&d, &bits, sizeof(d));
+    } while (!isfinite(d));
+    return d;
+}
+
+// 与 strtod 逐位比较随机生成的数字，包括极长的尾数和恰在两个 double 中点附近的值
+static void test_parse_num_random(void)
+{
+    char json[1024];
+    for (int i = 0; i < 100000; i++) {
+        char *p = json;
+        double d = rand_double();
+        switch (i % 4) {
+            case 0:
+                sprintf(json, "%.17g", d);
+                break;
+            case 1:
+                sprintf(json, "%.*g", (int)(rand_u64() % 17) + 1, d);
+                break;
+            case 2:
+                *p++ = '1' + rand_u64() % 9;
+                for (int n = rand_u64() % 24; n > 0; n--) {
+                    *p++ = '0' + rand_u64() % 10;
+                }
+                *p++ = '.';
+                for (int n = rand_u64() % 24 + 1; n > 0; n--) {
+                    *p++ = '0' + rand_u64() % 10;
+                }
+                sprintf(p, "e%d", (int)(rand_u64() % 700) - 350);
+                break;
+            default: {
+                // 两个相邻 double 的中点可以被 long double 精确表示
+                static const int precision[] = {17, 25, 40, 800};
+                double next;
+                uint64_t bits;
+                memcpy(&bits, &d, sizeof(d));
+                bits++;
+                memcpy(&next, &bits, sizeof(next));
+                long double mid = ((long double)d + next) / 2;
+                sprintf(json, "%.*Le", precision[i / 4 % 4], mid);
+            }
+        }
+        if (i % 8 >= 4) {
+            memmove(json + 1, json, strlen(json) + 1);
+            json[0] = '-';
+        }
+        double expect = strtod(json, NULL);
+        phot_elem e;
+        phot_init(&e);
+        if (isinf(expect)) {
+            EXPECT_EQ_INT(PHOT_PARSE_NUM_TOO_BIG, phot_parse(&e, json));
+        } else {
+            EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+            EXPECT_TRUE(memcmp(&expect, &e.num, sizeof(double)) == 0);
+            if (memcmp(&expect, &e.num, sizeof(double)) != 0) {
+                fprintf(stderr, "%s: expect %.17g actual %.17g\n", json, expect, e.num);
+            }
+        }
+        phot_free(&e);
+    }
 }
 
 #define TEST_STR(expect, json)                                         \
@@ -216,6 +316,94 @@ static void test_parse_obj(void)
     phot_free(&e);
 }
 
+// 各指令集下，特殊字符出现在块内的任意位置、字符串起始于任意对齐时都应解析正确
+static void test_parse_simd(void)
+{
+    char buf[192], expect[128];
+    for (int simd = PHOT_SIMD_SCALAR; simd <= PHOT_SIMD_AVX2; simd++) {
+        phot_set_simd((phot_simd)simd);
+        test_parse_str();
+        for (size_t offset = 0; offset < 32; offset++) {
+            for (size_t len = 0; len < 70; len++) {
+                char *json = buf + offset;
+                phot_elem e;
+                json[0] = '"';
+                memset(json + 1, 'a', len);
+                memcpy(json + 1 + len, "\\tb\"", 5);
+                memset(expect, 'a', len);
+                memcpy(expect + len, "\tb", 2);
+                phot_init(&e);
+                EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+                EXPECT_EQ_SIZE_T(len + 2, phot_get_str_len(&e));
+                EXPECT_TRUE(memcmp(expect, phot_get_str(&e), len + 2) == 0);
+                phot_free(&e);
+                json[len + 1] = '\0';
+                EXPECT_EQ_INT(PHOT_PARSE_MISS_QUOTATION_MARK, phot_parse(&e, json));
+                json[len + 1] = '\x1F';
+                EXPECT_EQ_INT(PHOT_PARSE_INVALID_STR_CHAR, phot_parse(&e, json));
+
+                // 各种空白组成的长度为 len 的空白串
+                for (size_t i = 0; i < len; i++) {
+                    json[i] = " \t\n\r    "[(i * 7 + offset) % 8];
+                }
+                memcpy(json + len, "[1,", 4);
+                memcpy(json + len + 3, json, len);
+                memcpy(json + len * 2 + 3, "2]", 3);
+                EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+                EXPECT_EQ_SIZE_T(2, phot_get_arr_len(&e));
+                phot_free(&e);
+                json[len] = '\0';
+                EXPECT_EQ_INT(PHOT_PARSE_EXPECT_VALUE, phot_parse(&e, json));
+            }
+        }
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+}
+
+#define TEST_INSITU_STR(expect, json)                                  \
+    do {                                                               \
+        char buf[] = json;                                             \
+        phot_elem e;                                                   \
+        phot_init(&e);                                                 \
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_insitu(&e, buf));      \
+        EXPECT_EQ_INT(PHOT_STR, phot_get_type(&e));                    \
+        EXPECT_EQ_STR(expect, phot_get_str(&e), phot_get_str_len(&e)); \
+        EXPECT_TRUE(phot_get_str(&e) == buf + 1);                      \
+        EXPECT_TRUE(phot_get_str(&e)[phot_get_str_len(&e)] == '\0');  \
+        phot_free(&e);                                                 \
+    } while (0)
+
+static void test_parse_insitu(void)
+{
+    TEST_INSITU_STR("", "\"\"");
+    TEST_INSITU_STR("Hello", "\"Hello\"");
+    TEST_INSITU_STR("Hello\nWorld", "\"Hello\\nWorld\"");
+    TEST_INSITU_STR("\" \\ / \b \f \n \r \t", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"");
+    TEST_INSITU_STR("Hello\0World", "\"Hello\\u0000World\"");
+    TEST_INSITU_STR("\xE2\x82\xAC", "\"\\u20AC\"");
+    TEST_INSITU_STR("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");
+
+    char buf[] = "{\"k\\\\ey\":[\"a\\tb\", {\"x\":\"y\"}], \"s\":\"t\"}";
+    phot_elem e, copy, moved;
+    phot_init(&e);
+    phot_init(&copy);
+    phot_init(&moved);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_insitu(&e, buf));
+    EXPECT_EQ_STR("k\\ey", phot_get_obj_key(&e, 0), phot_get_obj_key_len(&e, 0));
+    EXPECT_EQ_STR("a\tb", phot_get_str(phot_get_arr_elem(phot_get_obj_value(&e, 0), 0)), 3);
+    phot_copy(&copy, &e);
+    phot_move(&moved, phot_find_obj_value(&e, "s", 1));
+    EXPECT_EQ_STR("t", phot_get_str(&moved), phot_get_str_len(&moved));
+    phot_set_num(phot_set_obj_value(&e, "n", 1), 1.0);  // 插入新键时借用的键会被复制
+    EXPECT_EQ_SIZE_T(3, phot_get_obj_len(&e));
+    phot_free(&e);
+    phot_free(&moved);
+    memset(buf, 0, sizeof(buf));  // 深拷贝不再依赖原缓冲区
+    EXPECT_EQ_STR("k\\ey", phot_get_obj_key(&copy, 0), phot_get_obj_key_len(&copy, 0));
+    EXPECT_EQ_STR("t", phot_get_str(phot_find_obj_value(&copy, "s", 1)), 1);
+    phot_free(&copy);
+}
+
 // 错误解析
 #define TEST_ERROR(error, json)                      \
     do {                                             \
@@ -345,28 +533,528 @@ static void test_parse_miss_comma_or_curly_bracket(void)
     TEST_ERROR(PHOT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":{}");
 }
 
+// 把收到的事件记录成文本，remain 个事件之后中止
+typedef struct {
+    char buf[256];
+    size_t len;
+    int remain;
+} sax_recorder;
+
+static bool sax_record(sax_recorder *r, const char *text, size_t len)
+{
+    memcpy(r->buf + r->len, text, len);
+    r->len += len;
+    r->buf[r->len] = '\0';
+    return --r->remain != 0;
+}
+
+static bool sax_null(void *ud) { return sax_record((sax_recorder *)ud, "n ", 2); }
+static bool sax_bool(void *ud, bool b) { return sax_record((sax_recorder *)ud, b ? "t " : "f ", 2); }
+static bool sax_start_arr(void *ud) { return sax_record((sax_recorder *)ud, "[ ", 2); }
+static bool sax_start_obj(void *ud) { return sax_record((sax_recorder *)ud, "{ ", 2); }
+
+static bool sax_num(void *ud, double num)
+{
+    char text[32];
+    return sax_record((sax_recorder *)ud, text, sprintf(text, "%g ", num));
+}
+
+static bool sax_str(void *ud, const char *str, size_t len)
+{
+    char text[64];
+    return sax_record((sax_recorder *)ud, text, sprintf(text, "s:%.*s ", (int)len, str));
+}
+
+static bool sax_key(void *ud, const char *key, size_t klen)
+{
+    char text[64];
+    return sax_record((sax_recorder *)ud, text, sprintf(text, "k:%.*s ", (int)klen, key));
+}
+
+static bool sax_end_arr(void *ud, size_t count)
+{
+    char text[32];
+    return sax_record((sax_recorder *)ud, text, sprintf(text, "]%zu ", count));
+}
+
+static bool sax_end_obj(void *ud, size_t count)
+{
+    char text[32];
+    return sax_record((sax_recorder *)ud, text, sprintf(text, "}%zu ", count));
+}
+
+static const phot_handler sax_recorder_handler = {
+    sax_null, sax_bool, sax_num, sax_str, sax_start_arr, sax_end_arr, sax_start_obj, sax_key, sax_end_obj,
+};
+
+#define TEST_SAX(expect_ret, expect, json, limit)                                   \
+    do {                                                                            \
+        sax_recorder r;                                                             \
+        r.len = 0;                                                                  \
+        r.buf[0] = '\0';                                                            \
+        r.remain = limit;                                                           \
+        EXPECT_EQ_INT(expect_ret, phot_parse_sax(json, &sax_recorder_handler, &r)); \
+        EXPECT_EQ_STR(expect, r.buf, r.len);                                        \
+    } while (0)
+
+static bool sax_sum_num(void *ud, double num)
+{
+    *(double *)ud += num;
+    return true;
+}
+
+static void test_parse_sax(void)
+{
+    TEST_SAX(PHOT_PARSE_OK, "n ", " null ", -1);
+    TEST_SAX(PHOT_PARSE_OK, "s:a\\b ", "\"a\\\\b\"", -1);
+    TEST_SAX(PHOT_PARSE_OK, "[ ]0 ", "[ ]", -1);
+    TEST_SAX(PHOT_PARSE_OK, "{ }0 ", "{ }", -1);
+    TEST_SAX(PHOT_PARSE_OK, "[ n f t 1.5 s:abc [ 1 ]1 ]6 ", "[null,false,true,1.5,\"abc\",[1]]", -1);
+    TEST_SAX(PHOT_PARSE_OK, "{ k:a 1 k:b { k:c [ ]0 }1 k:a n }3 ", "{\"a\":1,\"b\":{\"c\":[]},\"a\":null}", -1);
+
+    // 回调返回 false 后不再发出事件
+    TEST_SAX(PHOT_PARSE_ABORTED, "[ n f ", "[null,false,true]", 3);
+    TEST_SAX(PHOT_PARSE_ABORTED, "{ k:a ", "{\"a\":1}", 2);
+    TEST_SAX(PHOT_PARSE_ABORTED, "{ k:a 1 }1 ", "{\"a\":1}", 4);
+
+    // 出错前已发出的事件保留
+    TEST_SAX(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[ 1 ", "[1}", -1);
+    TEST_SAX(PHOT_PARSE_MISS_COLON, "{ k:a ", "{\"a\" 1}", -1);
+    TEST_SAX(PHOT_PARSE_INVALID_VALUE, "[ 1 ", "[1,nul]", -1);
+    TEST_SAX(PHOT_PARSE_ROOT_NOT_SINGULAR, "n ", "null x", -1);
+
+    // 只关心部分事件时其余回调可以为空
+    phot_handler handler = {0};
+    handler.num = sax_sum_num;
+    double sum = 0.0;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_sax("{\"a\":[1,2,{\"b\":3.5}],\"c\":\"4\",\"d\":-0.5}", &handler, &sum));
+    EXPECT_EQ_DOUBLE(6.0, sum);
+}
+
+// 按 chunk 字节分块送入增量解析器
+static int stream_parse(phot_elem *e, const char *json, size_t len, size_t chunk)
+{
+    phot_stream s;
+    phot_stream_init(&s, e);
+    for (size_t i = 0; i < len; i += chunk) {
+        phot_stream_feed(&s, json + i, len - i < chunk ? len - i : chunk);
+    }
+    return phot_stream_finish(&s);
+}
+
+// 在任意位置切成两块、逐字节送入时，结果都应与 phot_parse 一致
+static void test_stream_case(const char *json)
+{
+    size_t len = strlen(json);
+    phot_elem expect, e;
+    phot_init(&expect);
+    int expect_ret = phot_parse(&expect, json);
+    for (size_t split = 0; split <= len; split++) {
+        phot_stream s;
+        phot_stream_init(&s, &e);
+        phot_stream_feed(&s, json, split);
+        phot_stream_feed(&s, json + split, len - split);
+        EXPECT_EQ_INT(expect_ret, phot_stream_finish(&s));
+        if (expect_ret == PHOT_PARSE_OK) {
+            EXPECT_TRUE(phot_is_equal(&expect, &e));
+        }
+        phot_free(&e);
+    }
+    EXPECT_EQ_INT(expect_ret, stream_parse(&e, json, len, 1));
+    if (expect_ret == PHOT_PARSE_OK) {
+        EXPECT_TRUE(phot_is_equal(&expect, &e));
+    }
+    phot_free(&e);
+    phot_free(&expect);
+
+    // 事件序列也应一致，包括出错前已经发出的事件
+    sax_recorder r1, r2;
+    r1.len = r2.len = 0;
+    r1.remain = r2.remain = -1;
+    expect_ret = phot_parse_sax(json, &sax_recorder_handler, &r1);
+    phot_stream s;
+    phot_stream_init_sax(&s, &sax_recorder_handler, &r2);
+    for (size_t i = 0; i < len; i++) {
+        phot_stream_feed(&s, json + i, 1);
+    }
+    EXPECT_EQ_INT(expect_ret, phot_stream_finish(&s));
+    EXPECT_EQ_SIZE_T(r1.len, r2.len);
+    EXPECT_TRUE(memcmp(r1.buf, r2.buf, r1.len) == 0);
+}
+
+static void test_parse_stream(void)
+{
+    static const char *cases[] = {
+        "null", " true ", "false", "0", "-0", "123", "-1.5e+10", "1E-10", "12345678901234567890123", "0.1",
+        "\"\"", "\"Hello\\nWorld\"", "\"\\\\\"", "\"a\\\"b\"", "\"\\\\\\\\\\\"\"",
+        "\"\\u00A2\\u20AC\\uD834\\uDD1E\"", "[]", "[ ]", "[null,false,true,123,\"abc\",[1,2,3]]", "{}",
+        "{ \"n\" : null , \"a\" : [ 1, 2, 3 ], \"o\" : { \"1\" : 1 }, \"k\\\\\" : \"v\" }", " [[[[ ]]]] ",
+        // 错误
+        "", " ", "nul", "tru", "fals", "?", "[1,]", "[1", "[1}", "[\"a\", nul]", "{", "{1:1}", "{\"a\"}",
+        "{\"a\":1", "{\"a\":1]", "{\"a\":1,", "\"abc", "\"abc\\", "\"\\v\"", "\"\\u12\"", "\"\\uD800\"",
+        "\"\x01\"", "1e309", "0123", "0x0", "1.", "-", "1-2", "1e", "[1e]", "null x", "truex", "[truex]",
+        "{\"a\":1 \"b\":2}",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        test_stream_case(cases[i]);
+    }
+
+    // 较大的文档按各种块大小送入
+    char *json = (char *)malloc(1 << 20);
+    char *p = json;
+    p += sprintf(p, "{\"items\":[");
+    for (int i = 0; i < 2000; i++) {
+        p += sprintf(p, "%s{\"id\":%d,\"name\":\"item\\t%d\\u00e9\",\"price\":%.17g,\"tags\":[true,false,null]}",
+                     i > 0 ? "," : "", i, i, i * 1.1);
+    }
+    p += sprintf(p, "],\"long\":\"");
+    for (int i = 0; i < 5000; i++) {
+        *p++ = i % 50 == 0 ? '\\' : 'a' + i % 26;
+        if (i % 50 == 0) {
+            *p++ = 'n';
+        }
+    }
+    strcpy(p, "\"}");
+    phot_elem expect, e;
+    phot_init(&expect);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&expect, json));
+    static const size_t chunks[] = {1, 2, 3, 7, 64, 4096, 65536};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        EXPECT_EQ_INT(PHOT_PARSE_OK, stream_parse(&e, json, strlen(json), chunks[i]));
+        EXPECT_TRUE(phot_is_equal(&expect, &e));
+        phot_free(&e);
+    }
+    phot_free(&expect);
+    free(json);
+}
+
+// 生成 depth 层交替嵌套的数组和对象，最内层为 1
+static char *gen_nested(size_t depth)
+{
+    char *json = (char *)malloc(depth * 6 + 2);
+    char *p = json;
+    for (size_t i = 0; i < depth; i++) {
+        if (i % 2 == 0) {
+            *p++ = '[';
+        } else {
+            memcpy(p, "{\"k\":", 5);
+            p += 5;
+        }
+    }
+    *p++ = '1';
+    for (size_t i = depth; i-- > 0;) {
+        *p++ = i % 2 == 0 ? ']' : '}';
+    }
+    *p = '\0';
+    return json;
+}
+
+static void test_parse_too_deep(void)
+{
+    size_t max_depth = phot_get_max_depth();
+    EXPECT_EQ_SIZE_T(1024, max_depth);
+    phot_elem e, copy;
+    phot_init(&e);
+    phot_init(&copy);
+    phot_set_max_depth(16);
+    char *ok = gen_nested(16), *deep = gen_nested(17);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, ok));
+    phot_free(&e);
+    TEST_ERROR(PHOT_PARSE_TOO_DEEP, deep);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, stream_parse(&e, ok, strlen(ok), 3));
+    phot_free(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_TOO_DEEP, stream_parse(&e, deep, strlen(deep), 3));
+    phot_doc doc;
+    phot_doc_init(&doc);
+    EXPECT_EQ_INT(PHOT_PARSE_TOO_DEEP, phot_parse_doc(&doc, deep));
+    phot_doc_free(&doc);
+    free(ok);
+    free(deep);
+
+    // 默认深度下，对抗性的输入得到错误而不是耗尽 C 栈
+    phot_set_max_depth(max_depth);
+    size_t depth = 1000000;
+    char *json = (char *)malloc(depth + 1);
+    memset(json, '[', depth);
+    json[depth] = '\0';
+    TEST_ERROR(PHOT_PARSE_TOO_DEEP, json);
+    free(json);
+
+    // 不限制深度时，解析、复制、比较、序列化和释放都不递归
+    phot_set_max_depth(0);
+    EXPECT_EQ_SIZE_T(0, phot_get_max_depth());
+    json = gen_nested(depth);
+    size_t n = strlen(json), len;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+    phot_copy(&copy, &e);
+    EXPECT_TRUE(phot_is_equal(&e, &copy));
+    char *out = phot_stringify(&copy, &len);
+    EXPECT_EQ_SIZE_T(n, len);
+    EXPECT_TRUE(memcmp(json, out, n) == 0);
+    free(out);
+    phot_stringify_opts opts = {0, ' ', false, true};
+    out = phot_stringify_ex(&copy, &opts, &len);
+    EXPECT_EQ_SIZE_T(n + depth / 2, len);
+    free(out);
+    phot_elem *inner = &copy;
+    while (phot_get_type(inner) != PHOT_NUM) {
+        inner = phot_get_type(inner) == PHOT_ARR ? phot_get_arr_elem(inner, 0) : phot_get_obj_value(inner, 0);
+    }
+    phot_set_num(inner, 2);
+    EXPECT_EQ_BOOL(false, phot_is_equal(&e, &copy));
+    phot_free(&copy);
+    phot_free(&e);
+    free(json);
+    phot_set_max_depth(max_depth);
+}
+
+// 按长度解析时不能读到 len 之后的字节：末尾紧跟的引号、数字和空白都会误导依赖 '\0' 的实现
+static void test_parse_n_case(const char *json)
+{
+    static const char *tails[] = {"", "\"", "0", " ", "ull", "\"}]"};
+    size_t len = strlen(json);
+    phot_elem expect, e;
+    phot_init(&expect);
+    int expect_ret = phot_parse(&expect, json);
+    for (size_t i = 0; i < sizeof(tails) / sizeof(tails[0]); i++) {
+        size_t tlen = strlen(tails[i]);
+        char *buf = (char *)malloc(len + tlen + 1);  // 至少分配 1 字节，len 为 0 时也有合法的指针
+        memcpy(buf, json, len);
+        memcpy(buf + len, tails[i], tlen);
+        phot_init(&e);
+        EXPECT_EQ_INT(expect_ret, phot_parse_n(&e, buf, len));
+        if (expect_ret == PHOT_PARSE_OK) {
+            EXPECT_TRUE(phot_is_equal(&expect, &e));
+        }
+        phot_free(&e);
+        free(buf);
+    }
+    phot_free(&expect);
+}
+
+static void test_parse_n(void)
+{
+    static const char *cases[] = {
+        "null", " true ", "false", "0", "-0", "123", "-1.5e+10", "1E-10", "0.1", "\"\"", "\"Hello\\nWorld\"",
+        "\"\\u00A2\\u20AC\\uD834\\uDD1E\"", "[]", "[null,false,true,123,\"abc\",[1,2,3]]",
+        "{ \"n\" : null , \"a\" : [ 1, 2, 3 ], \"o\" : { \"1\" : 1 } }",
+        // 错误
+        "", " ", "nul", "tru", "fals", "[1", "[1,", "{", "{\"a\"", "{\"a\":", "{\"a\":1", "\"abc", "\"abc\\",
+        "\"\\u12", "\"\\uD800", "\"\\uD800\\", "\"\\uD800\\uDC", "1.", "-", "1e", "1e+",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        test_parse_n_case(cases[i]);
+    }
+
+    // 输入中的 '\0' 只是普通的非法字符
+    phot_elem e;
+    phot_init(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_STR_CHAR, phot_parse_n(&e, "\"a\0b\"", 5));
+    EXPECT_EQ_INT(PHOT_PARSE_ROOT_NOT_SINGULAR, phot_parse_n(&e, "1\0", 2));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_parse_n(&e, "\0", 1));
+
+    // 解析大缓冲区中的一段
+    const char *msgs = "[1,2][\"abc\"]{}";
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&e, msgs, 5));
+    EXPECT_EQ_SIZE_T(2, phot_get_arr_len(&e));
+    phot_free(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&e, msgs + 5, 7));
+    EXPECT_EQ_STR("abc", phot_get_str(phot_get_arr_elem(&e, 0)), 3);
+    phot_free(&e);
+
+    // 各指令集下，输入结尾落在块内任意位置时，按块扫描都不能越过结尾
+    char buf[192];
+    for (int simd = PHOT_SIMD_SCALAR; simd <= PHOT_SIMD_AVX2; simd++) {
+        phot_set_simd((phot_simd)simd);
+        for (size_t offset = 0; offset < 32; offset++) {
+            for (size_t len = 0; len < 70; len++) {
+                char *json = buf + offset;
+                json[0] = '"';
+                memset(json + 1, 'a', len);
+                strcpy(json + 1 + len, "\"");
+                EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&e, json, len + 2));
+                EXPECT_EQ_SIZE_T(len, phot_get_str_len(&e));
+                phot_free(&e);
+                EXPECT_EQ_INT(PHOT_PARSE_MISS_QUOTATION_MARK, phot_parse_n(&e, json, len + 1));
+
+                for (size_t i = 0; i < len; i++) {
+                    json[i] = " \t\n\r    "[(i * 7 + offset) % 8];
+                }
+                strcpy(json + len, "1");
+                EXPECT_EQ_INT(PHOT_PARSE_EXPECT_VALUE, phot_parse_n(&e, json, len));
+                EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&e, json, len + 1));
+                EXPECT_EQ_DOUBLE(1.0, phot_get_num(&e));
+            }
+        }
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+}
+
+// 两种解析器实现对同一输入应给出相同的结果
+static void test_backend_case(const char *json, size_t len)
+{
+    phot_elem e1, e2;
+    phot_init(&e1);
+    phot_init(&e2);
+    phot_set_backend(PHOT_BACKEND_DESCENT);
+    int ret = phot_parse_n(&e1, json, len);
+    phot_set_backend(PHOT_BACKEND_INDEX);
+    EXPECT_EQ_INT(ret, phot_parse_n(&e2, json, len));
+    if (ret == PHOT_PARSE_OK) {
+        EXPECT_TRUE(phot_is_equal(&e1, &e2));
+    }
+    phot_free(&e1);
+    phot_free(&e2);
+}
+
+static void test_parse_backend(void)
+{
+    // 没有以 PHOT_USE_INDEX_BACKEND=1 编译库时只有逐字节识别结构的实现
+    if (phot_set_backend(PHOT_BACKEND_INDEX) != PHOT_BACKEND_INDEX) {
+        EXPECT_TRUE(phot_get_backend() == PHOT_BACKEND_DESCENT);
+        return;
+    }
+    phot_set_backend(PHOT_BACKEND_DESCENT);
+    // 跨越多个 64 字节块和索引窗口的长字符串，反斜杠序列落在块边界两侧
+    char *json = (char *)malloc(1 << 16);
+    char *p = json;
+    p += sprintf(p, "[");
+    for (int i = 0; i < 6; i++) {
+        *p++ = '"';
+        for (int j = 0; j < 5000; j++) {
+            if (j % 61 < i + 1) {
+                *p++ = '\\';
+                *p++ = j % 61 == i ? '"' : '\\';
+            } else {
+                *p++ = 'a' + j % 26;
+            }
+        }
+        p += sprintf(p, "\", %d , true ,null, { \"k\" :\t[ 1.5e3 ] }  \n,", i);
+    }
+    strcpy(p, "\"end\"]");
+    size_t len = strlen(json);
+    phot_set_backend(PHOT_BACKEND_INDEX);
+    phot_elem e;
+    phot_init(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+    EXPECT_EQ_SIZE_T(31, phot_get_arr_len(&e));
+    phot_free(&e);
+
+    // 随机修改若干字节，两种实现的错误码和结果都应一致
+    static const char alphabet[] = "{}[]:,\"\\ \t\nabefnlrstu0123456789.-+eEx\0";
+    uint64_t state = 88172645463325252ULL;
+    char *buf = (char *)malloc(len);
+    static const phot_simd levels[] = {PHOT_SIMD_SCALAR, PHOT_SIMD_AVX2};  // 第一阶段只有这两种分类实现
+    for (size_t i = 0; i < 2; i++) {
+        phot_set_simd(levels[i]);
+        test_backend_case(json, len);
+        for (int round = 0; round < 3000; round++) {
+            size_t n = len;
+            memcpy(buf, json, len);
+            for (int k = 0; k < 1 + round % 3; k++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                size_t pos = (state >> 8) % n;
+                buf[pos] = alphabet[(state >> 40) % (sizeof(alphabet) - 1)];
+                if (round % 5 == 0) {
+                    n = pos + 1;  // 截断
+                }
+            }
+            test_backend_case(buf, n);
+        }
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+    phot_set_backend(PHOT_BACKEND_DESCENT);
+    free(buf);
+    free(json);
+}
+
+// 只有以 PHOT_USE_STATS=1 编译库时才有统计，否则结果清零
+static void test_parse_stats(void)
+{
+    const char *json = " {\"a\":[1,true,null,\"x\\ny\"],\"long key over sso\":{\"c\":false}} ";
+    phot_elem e;
+    phot_parse_stats st;
+    phot_init(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+    if (!phot_get_parse_stats(&st)) {
+        EXPECT_EQ_SIZE_T(0, st.bytes);
+        EXPECT_EQ_SIZE_T(0, st.allocs);
+        phot_free(&e);
+        return;
+    }
+    EXPECT_EQ_SIZE_T(strlen(json), st.bytes);
+    EXPECT_EQ_SIZE_T(1, st.values[PHOT_NULL]);
+    EXPECT_EQ_SIZE_T(2, st.values[PHOT_BOOL]);
+    EXPECT_EQ_SIZE_T(1, st.values[PHOT_NUM]);
+    EXPECT_EQ_SIZE_T(1, st.values[PHOT_STR]);
+    EXPECT_EQ_SIZE_T(1, st.values[PHOT_ARR]);
+    EXPECT_EQ_SIZE_T(2, st.values[PHOT_OBJ]);
+    EXPECT_EQ_SIZE_T(3, st.keys);
+    EXPECT_EQ_SIZE_T(2, st.max_depth);
+    EXPECT_EQ_SIZE_T(3, st.strs_fast);
+    EXPECT_EQ_SIZE_T(1, st.strs_escaped);
+    EXPECT_TRUE(st.stack_peak > 0 && st.stack_reallocs > 0);
+    EXPECT_TRUE(st.allocs >= 4);  // 解析栈、数组、两个对象，长键
+    EXPECT_TRUE(st.parse_seconds >= 0.0);
+    EXPECT_TRUE(phot_get_backend() == PHOT_BACKEND_INDEX || st.index_seconds == 0.0);
+    phot_free(&e);
+
+    // 出错时停在出错的位置
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, phot_parse(&e, "[[1],[2 3]]"));
+    phot_get_parse_stats(&st);
+    EXPECT_EQ_SIZE_T(8, st.bytes);
+    EXPECT_EQ_SIZE_T(2, st.values[PHOT_NUM]);
+    EXPECT_EQ_SIZE_T(2, st.max_depth);
+
+    // 文档模式复用解析栈和 arena，第二次解析不再分配
+    phot_doc doc;
+    phot_doc_init(&doc);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+    phot_get_parse_stats(&st);
+    EXPECT_EQ_SIZE_T(0, st.allocs);
+    EXPECT_EQ_SIZE_T(0, st.stack_reallocs);
+    phot_doc_free(&doc);
+}
+
 static void test_parse(void)
 {
-    test_parse_null();
-    test_parse_bool();
-    test_parse_num();
-    test_parse_str();
-    test_parse_arr();
-    test_parse_obj();
-
-    test_parse_expect_value();
-    test_parse_invalid_value();
-    test_parse_root_not_singular();
-    test_parse_num_too_big();
-    test_parse_missing_quotation_mark();
-    test_parse_invalid_str_escape();
-    test_parse_invalid_str_char();
-    test_parse_invalid_unicode_hex();
-    test_parse_invalid_unicode_surrogate();
-    test_parse_miss_comma_or_square_bracket();
-    test_parse_miss_key();
-    test_parse_miss_colon();
-    test_parse_miss_comma_or_curly_bracket();
+    // 结构索引的实现应通过同样的测试
+    for (int backend = PHOT_BACKEND_DESCENT; backend <= PHOT_BACKEND_INDEX; backend++) {
+        phot_set_backend((phot_backend)backend);
+        test_parse_null();
+        test_parse_bool();
+        test_parse_num();
+        test_parse_num_random();
+        test_parse_str();
+        test_parse_arr();
+        test_parse_obj();
+        test_parse_simd();
+        test_parse_insitu();
+        test_parse_sax();
+        test_parse_stream();
+        test_parse_n();
+        test_parse_stats();
+
+        test_parse_expect_value();
+        test_parse_invalid_value();
+        test_parse_root_not_singular();
+        test_parse_num_too_big();
+        test_parse_missing_quotation_mark();
+        test_parse_invalid_str_escape();
+        test_parse_invalid_str_char();
+        test_parse_invalid_unicode_hex();
+        test_parse_invalid_unicode_surrogate();
+        test_parse_miss_comma_or_square_bracket();
+        test_parse_miss_key();
+        test_parse_miss_colon();
+        test_parse_miss_comma_or_curly_bracket();
+        test_parse_too_deep();
+    }
+    phot_set_backend(PHOT_BACKEND_DESCENT);
+    test_parse_backend();
 }
 
 #define TEST_ROUNDTRIP(json)                                \
@@ -393,14 +1081,79 @@ static void test_stringify_num(void)
     TEST_ROUNDTRIP("1.234e+20");
     TEST_ROUNDTRIP("1.234e-20");
     TEST_ROUNDTRIP("1.0000000000000002");       // 大于 1 的最小精度
-    TEST_ROUNDTRIP("4.9406564584124654e-324");  // 最小次正规数
-    TEST_ROUNDTRIP("-4.9406564584124654e-324");
-    TEST_ROUNDTRIP("2.2250738585072009e-308");  // 最大次正规数
-    TEST_ROUNDTRIP("-2.2250738585072009e-308");
+    TEST_ROUNDTRIP("5e-324");  // 最小次正规数
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");  // 最大次正规数
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
     TEST_ROUNDTRIP("2.2250738585072014e-308");  // 最小正规数
     TEST_ROUNDTRIP("-2.2250738585072014e-308");
     TEST_ROUNDTRIP("1.7976931348623157e+308");  // 最大正规数
     TEST_ROUNDTRIP("-1.7976931348623157e+308");
+    TEST_ROUNDTRIP("0.1");
+    TEST_ROUNDTRIP("0.3");
+    TEST_ROUNDTRIP("0.0001");
+    TEST_ROUNDTRIP("1e-05");
+    TEST_ROUNDTRIP("123.456");
+    TEST_ROUNDTRIP("99999999999999984");
+    TEST_ROUNDTRIP("1e+17");
+    TEST_ROUNDTRIP("1.2345678901234568e+20");
+    TEST_ROUNDTRIP("-1.5e+300");
+}
+
+#define TEST_STRINGIFY_NUM(expect, num)           \
+    do {                                          \
+        phot_elem e;                              \
+        phot_init(&e);                            \
+        phot_set_num(&e, num);                    \
+        size_t len;                               \
+        char *json = phot_stringify(&e, &len);    \
+        EXPECT_EQ_STR(expect, json, len);         \
+        phot_free(&e);                            \
+        free(json);                               \
+    } while (0)
+
+static void test_stringify_num_shortest(void)
+{
+    TEST_STRINGIFY_NUM("0.1", 0.1);
+    TEST_STRINGIFY_NUM("0.30000000000000004", 0.1 + 0.2);
+    TEST_STRINGIFY_NUM("-0", -0.0);
+    TEST_STRINGIFY_NUM("100", 100.0);
+    TEST_STRINGIFY_NUM("-42", -42.0);
+    TEST_STRINGIFY_NUM("9007199254740992", 9007199254740992.0);
+    TEST_STRINGIFY_NUM("10000000000000000", 1e16);
+    TEST_STRINGIFY_NUM("1e+17", 1e17);
+    TEST_STRINGIFY_NUM("1e+100", 1e100);
+    TEST_STRINGIFY_NUM("1.5e-07", 1.5e-7);
+    TEST_STRINGIFY_NUM("0.00015", 1.5e-4);
+    TEST_STRINGIFY_NUM("123456.789", 123456.789);
+    TEST_STRINGIFY_NUM("5e-324", 4.9406564584124654e-324);
+}
+
+// 随机的 double 序列化后再解析必须得到相同的位，且不比 "%.17g" 长
+static void test_stringify_num_random(void)
+{
+    for (int i = 0; i < 100000; i++) {
+        double d = rand_double();
+        if (i % 4 == 0) {
+            d = (double)(int64_t)(rand_u64() >> (rand_u64() % 64)) * (rand_u64() & 1 ? 1 : -1);
+        } else if (i % 4 == 1) {
+            d = (double)(int64_t)(rand_u64() % 2000000 - 1000000) / 1000;
+        }
+        phot_elem e;
+        phot_init(&e);
+        phot_set_num(&e, d);
+        size_t len;
+        char *json = phot_stringify(&e, &len);
+        char expect[32];
+        EXPECT_TRUE(len <= (size_t)sprintf(expect, "%.17g", d));
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+        EXPECT_TRUE(memcmp(&d, &e.num, sizeof(double)) == 0);
+        if (memcmp(&d, &e.num, sizeof(double)) != 0) {
+            fprintf(stderr, "%s: expect %.17g actual %.17g\n", json, d, e.num);
+        }
+        phot_free(&e);
+        free(json);
+    }
 }
 
 static void test_stringify_str(void)
@@ -412,6 +1165,44 @@ static void test_stringify_str(void)
     TEST_ROUNDTRIP("\"Hello\\u0000World\"");
 }
 
+// 各指令集下，需要转义的字符出现在任意位置时输出都与标量实现相同，并能解析回原字符串
+static void test_stringify_str_simd(void)
+{
+    static const char pool[] = {'a', 'z', '"', '\\', '/', '\n', '\x01', '\x1F', ' ', '\x7F', '\xE4', '\xB8', '\x80'};
+    static const size_t lens[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200, 6000};
+    char *buf = (char *)malloc(6000);
+    phot_elem e, back;
+    phot_init(&e);
+    phot_init(&back);
+    for (size_t n = 0; n < sizeof(lens) / sizeof(lens[0]); n++) {
+        for (int round = 0; round < 20; round++) {
+            // 每轮特殊字符的密度不同，从全是普通字符到全是特殊字符
+            for (size_t i = 0; i < lens[n]; i++) {
+                buf[i] = rand_u64() % 20 < (uint64_t)round ? pool[rand_u64() % sizeof(pool)] : (char)('a' + i % 26);
+            }
+            phot_set_str(&e, buf, lens[n]);
+            phot_set_simd(PHOT_SIMD_SCALAR);
+            size_t expect_len, len;
+            char *expect = phot_stringify(&e, &expect_len);
+            for (int simd = PHOT_SIMD_SWAR; simd <= PHOT_SIMD_AVX2; simd++) {
+                phot_set_simd((phot_simd)simd);
+                char *json = phot_stringify(&e, &len);
+                EXPECT_EQ_SIZE_T(expect_len, len);
+                EXPECT_TRUE(memcmp(expect, json, len) == 0);
+                free(json);
+            }
+            EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&back, expect, expect_len));
+            EXPECT_TRUE(phot_is_equal(&e, &back));
+            phot_free(&back);
+            free(expect);
+        }
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+    phot_free(&e);
+    phot_free(&back);
+    free(buf);
+}
+
 static void test_stringify_arr(void)
 {
     TEST_ROUNDTRIP("[]");
@@ -425,15 +1216,166 @@ static void test_stringify_obj(void)
         "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
 }
 
+typedef struct {
+    char *buf;
+    size_t len, cap;
+    size_t calls, max_chunk;
+    size_t fail_after;  // 第几次调用开始失败，0 表示不失败
+} write_recorder;
+
+static bool record_write(void *ud, const char *buf, size_t len)
+{
+    write_recorder *w = (write_recorder *)ud;
+    if (w->fail_after != 0 && w->calls + 1 >= w->fail_after) {
+        w->calls++;
+        return false;
+    }
+    if (w->len + len > w->cap) {
+        w->cap = (w->len + len) * 2;
+        w->buf = (char *)realloc(w->buf, w->cap);
+    }
+    memcpy(w->buf + w->len, buf, len);
+    w->len += len;
+    w->calls++;
+    if (len > w->max_chunk) {
+        w->max_chunk = len;
+    }
+    return true;
+}
+
+// 流式序列化与 phot_stringify 的结果逐字节相同，每次交给回调的输出不超过缓冲区的两倍
+static void test_stringify_stream(void)
+{
+    phot_elem e;
+    phot_init(&e);
+    phot_set_arr(&e, 0);
+    size_t big_len = 300000;
+    char *big = (char *)malloc(big_len);
+    for (size_t i = 0; i < big_len; i++) {
+        big[i] = i % 97 == 0 ? '\n' : i % 89 == 0 ? '\x01' : (char)('a' + i % 26);
+    }
+    phot_set_str(phot_push_arr(&e), big, big_len);
+    for (size_t i = 0; i < 20000; i++) {
+        phot_elem *o = phot_push_arr(&e);
+        phot_set_obj(o, 2);
+        phot_set_num(phot_set_obj_value(o, "id", 2), (double)i);
+        phot_set_str(phot_set_obj_value(o, "text \"quoted\"", 13), "tab\there", 8);
+    }
+    phot_set_str(phot_push_arr(&e), "", 0);
+    size_t len;
+    char *json = phot_stringify(&e, &len);
+
+    write_recorder w = {NULL, 0, 0, 0, 0, 0};
+    EXPECT_EQ_INT(0, phot_stringify_to(&e, record_write, &w));
+    EXPECT_EQ_SIZE_T(len, w.len);
+    EXPECT_TRUE(memcmp(json, w.buf, len) == 0);
+    EXPECT_TRUE(w.calls > 10 && w.max_chunk <= 2 * 65536);
+
+    // 回调失败后不再被调用
+    write_recorder fail = {NULL, 0, 0, 0, 0, 3};
+    EXPECT_EQ_INT(-1, phot_stringify_to(&e, record_write, &fail));
+    EXPECT_EQ_SIZE_T(3, fail.calls);
+
+    FILE *fp = tmpfile();
+    EXPECT_TRUE(fp != NULL);
+    EXPECT_EQ_INT(0, phot_stringify_fp(&e, fp));
+    EXPECT_TRUE((size_t)ftell(fp) == len);
+    rewind(fp);
+    char *back = (char *)malloc(len);
+    EXPECT_EQ_SIZE_T(len, fread(back, 1, len, fp));
+    EXPECT_TRUE(memcmp(json, back, len) == 0);
+    fclose(fp);
+#ifndef _WIN32
+    fp = tmpfile();
+    EXPECT_EQ_INT(0, phot_stringify_fd(&e, fileno(fp)));
+    rewind(fp);
+    memset(back, 0, len);
+    EXPECT_EQ_SIZE_T(len, fread(back, 1, len, fp));
+    EXPECT_TRUE(memcmp(json, back, len) == 0);
+    fclose(fp);
+    EXPECT_EQ_INT(-1, phot_stringify_fd(&e, -1));
+#endif
+
+    free(back);
+    free(w.buf);
+    free(fail.buf);
+    free(json);
+    free(big);
+    phot_free(&e);
+}
+
+#define TEST_PRETTY(expect, json, ...)                                         \
+    do {                                                                       \
+        phot_elem e;                                                           \
+        phot_stringify_opts opts = {__VA_ARGS__};                              \
+        size_t len;                                                            \
+        phot_init(&e);                                                         \
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));                    \
+        char *out = phot_stringify_ex(&e, &opts, &len);                        \
+        EXPECT_EQ_STR(expect, out, len);                                       \
+        free(out);                                                             \
+        phot_free(&e);                                                         \
+    } while (0)
+
+static void test_stringify_pretty(void)
+{
+    TEST_PRETTY("[1,{\"a\":2}]", "[1,{\"a\":2}]", 0, 0, false, false);
+    TEST_PRETTY("[1,{\"a\": 2}]", "[1,{\"a\":2}]", 0, 0, false, true);
+    TEST_PRETTY("[]", "[]", 2, ' ', false, true);
+    TEST_PRETTY("{}", "{}", 2, ' ', false, true);
+    TEST_PRETTY("\"s\"", "\"s\"", 2, ' ', false, true);
+    TEST_PRETTY("[\n  1,\n  {\n    \"a\":2,\n    \"b\":[]\n  }\n]", "[1,{\"a\":2,\"b\":[]}]", 2, ' ', false, false);
+    TEST_PRETTY("{\n\t\"a\": [\n\t\ttrue\n\t]\n}", "{\"a\":[true]}", 1, '\t', false, true);
+    TEST_PRETTY("{\r\n    \"a\": null\r\n}", "{\"a\":null}", 4, '\0', true, true);
+
+    // 缩进超过预先生成的长度，输出能还原为同一棵树，流式输出逐字节相同
+    phot_elem e, back;
+    phot_init(&e);
+    phot_init(&back);
+    phot_set_arr(&e, 0);
+    phot_elem *p = &e;
+    for (int i = 0; i < 100; i++) {
+        phot_set_num(phot_push_arr(p), i);
+        p = phot_push_arr(p);
+        phot_set_obj(p, 1);
+        p = phot_set_obj_value(p, "k", 1);
+        phot_set_arr(p, 0);
+    }
+    phot_stringify_opts opts = {4, ' ', false, true};
+    size_t len;
+    char *json = phot_stringify_ex(&e, &opts, &len);
+    size_t run = 0, max_run = 0;
+    for (size_t i = 0; i < len; i++) {
+        run = json[i] == ' ' ? run + 1 : 0;
+        max_run = run > max_run ? run : max_run;
+    }
+    EXPECT_EQ_SIZE_T(4 * 200, max_run);  // 最深的键在第 200 层
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&back, json));
+    EXPECT_TRUE(phot_is_equal(&e, &back));
+    write_recorder w = {NULL, 0, 0, 0, 0, 0};
+    EXPECT_EQ_INT(0, phot_stringify_to_ex(&e, &opts, record_write, &w));
+    EXPECT_EQ_SIZE_T(len, w.len);
+    EXPECT_TRUE(memcmp(json, w.buf, len) == 0);
+    free(w.buf);
+    free(json);
+    phot_free(&back);
+    phot_free(&e);
+}
+
 static void test_stringify(void)
 {
     TEST_ROUNDTRIP("null");
     TEST_ROUNDTRIP("false");
     TEST_ROUNDTRIP("true");
     test_stringify_num();
+    test_stringify_num_shortest();
+    test_stringify_num_random();
     test_stringify_str();
     test_stringify_arr();
     test_stringify_obj();
+    test_stringify_str_simd();
+    test_stringify_stream();
+    test_stringify_pretty();
 }
 
 #define TEST_EQUAL(json1, json2, equality)                    \
@@ -526,6 +1468,475 @@ static void test_file(void)
     phot_free(e2);
     free(e1);
     free(e2);
+
+    phot_elem e;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_file(&e, "test.in.json"));
+    phot_elem *e3 = phot_read_from_file("test.in.json");
+    EXPECT_TRUE(phot_is_equal(&e, e3));
+    phot_free(e3);
+    free(e3);
+    phot_free(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_FILE_ERROR, phot_parse_file(&e, "test.missing.json"));
+    EXPECT_EQ_INT(PHOT_NULL, phot_get_type(&e));
+#if defined(__unix__) || defined(__APPLE__)
+    EXPECT_EQ_INT(PHOT_PARSE_EXPECT_VALUE, phot_parse_file(&e, "/dev/null"));  // 字符设备无法映射，走分块读入
+#endif
+
+    // 映射的内容不以 '\0' 结尾，交给增量解析器
+    phot_file_map m;
+    EXPECT_EQ_INT(0, phot_map_file(&m, "test.out.json"));
+    size_t len;
+    e2 = phot_read_from_file("test.out.json");
+    char *json = phot_stringify(e2, &len);
+    EXPECT_EQ_SIZE_T(len, m.len);
+    EXPECT_TRUE(memcmp(json, m.data, len) == 0);
+    phot_stream s;
+    phot_stream_init(&s, &e);
+    phot_stream_feed(&s, m.data, m.len);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_stream_finish(&s));
+    EXPECT_TRUE(phot_is_equal(&e, e2));
+    phot_unmap_file(&m);
+    phot_free(&e);
+    phot_free(e2);
+    free(e2);
+    free(json);
+    EXPECT_EQ_INT(-1, phot_map_file(&m, "test.missing.json"));
+}
+
+static void test_doc(void)
+{
+    const char *json = "{\"n\":null,\"s\":\"Hello\\nWorld\",\"a\":[1,2,{\"k\":\"v\"}],\"o\":{\"1\":[]}}";
+    phot_doc doc;
+    phot_elem e;
+    phot_doc_init(&doc);
+    phot_init(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+        EXPECT_TRUE(phot_is_equal(&e, phot_doc_root(&doc)));
+    }
+    // 重复解析同样大小的文本不应再申请新的内存块
+    phot_chunk *head = doc.head;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+    EXPECT_TRUE(head == doc.head && doc.cur == doc.head);
+
+    // 修改文档树时，借用的内存会被复制到堆上
+    phot_elem *root = phot_doc_root(&doc);
+    phot_elem *a = phot_find_obj_value(root, "a", 1);
+    phot_set_num(phot_push_arr(a), 3.0);
+    EXPECT_EQ_SIZE_T(4, phot_get_arr_len(a));
+    EXPECT_EQ_DOUBLE(3.0, phot_get_num(phot_get_arr_elem(a, 3)));
+    phot_set_str(phot_set_obj_value(root, "new", 3), "value", 5);
+    EXPECT_EQ_SIZE_T(5, phot_get_obj_len(root));
+    EXPECT_EQ_STR("s", phot_get_obj_key(root, 1), phot_get_obj_key_len(root, 1));
+    phot_remove_obj_member(root, 0);
+    EXPECT_EQ_STR("Hello\nWorld", phot_get_str(phot_find_obj_value(root, "s", 1)), 11);
+    phot_free(root);
+
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, phot_parse_doc(&doc, "[\"a\",{\"b\":[1}]"));
+    EXPECT_EQ_INT(PHOT_NULL, phot_get_type(phot_doc_root(&doc)));
+    EXPECT_EQ_INT(PHOT_PARSE_ROOT_NOT_SINGULAR, phot_parse_doc(&doc, "[\"a\"] x"));
+    EXPECT_EQ_INT(PHOT_NULL, phot_get_type(phot_doc_root(&doc)));
+
+    // 元素只占 16 字节，容量保存在缓冲区之前的头部，arena 中的缓冲区也有头部
+    EXPECT_EQ_SIZE_T(16, sizeof(phot_elem));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, "[[1,2,3],{\"a\":1,\"b\":2},[]]"));
+    root = phot_doc_root(&doc);
+    phot_elem *arr = phot_get_arr_elem(root, 0), *obj = phot_get_arr_elem(root, 1);
+    EXPECT_EQ_SIZE_T(3, phot_get_arr_cap(arr));
+    EXPECT_EQ_SIZE_T(2, phot_get_obj_cap(obj));
+    EXPECT_EQ_SIZE_T(0, phot_get_arr_cap(phot_get_arr_elem(root, 2)));
+    phot_pop_arr(arr);
+    phot_shrink_arr(arr);
+    EXPECT_EQ_SIZE_T(2, phot_get_arr_cap(arr));
+    phot_set_num(phot_push_arr(arr), 4.0);
+    EXPECT_EQ_SIZE_T(4, phot_get_arr_cap(arr));
+    EXPECT_EQ_DOUBLE(4.0, phot_get_num(phot_get_arr_elem(arr, 2)));
+    phot_remove_obj_member(obj, 0);
+    phot_shrink_obj(obj);
+    EXPECT_EQ_SIZE_T(1, phot_get_obj_cap(obj));
+    phot_free(root);
+
+    phot_free(&e);
+    phot_doc_free(&doc);
+}
+
+// 通过访问函数遍历整棵树，惰性文档因此完全展开
+static size_t lazy_walk(const phot_elem *e)
+{
+    size_t invalid = phot_get_status(e) != PHOT_PARSE_OK;
+    switch (phot_get_type(e)) {
+        case PHOT_NUM:
+            phot_get_num(e);
+            break;
+        case PHOT_STR:
+            phot_get_str(e);
+            break;
+        case PHOT_ARR:
+            for (size_t i = 0; i < phot_get_arr_len(e); i++) {
+                invalid += lazy_walk(phot_get_arr_elem(e, i));
+            }
+            break;
+        case PHOT_OBJ:
+            for (size_t i = 0; i < phot_get_obj_len(e); i++) {
+                invalid += lazy_walk(phot_get_obj_value(e, i));
+            }
+            break;
+        default:
+            break;
+    }
+    return invalid;
+}
+
+// 合法的输入展开后与 phot_parse_n 的结果相同；非法的输入要么在解析时出错，要么在完全展开后出错
+static void test_lazy_case(phot_doc *doc, const char *json, size_t len)
+{
+    phot_elem e;
+    phot_init(&e);
+    int ret = phot_parse_n(&e, json, len);
+    int lazy_ret = phot_parse_lazy(doc, json, len);
+    if (ret == PHOT_PARSE_OK) {
+        EXPECT_EQ_INT(PHOT_PARSE_OK, lazy_ret);
+        EXPECT_TRUE(phot_is_equal(&e, phot_doc_root(doc)));
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_doc_status(doc));
+    } else if (lazy_ret == PHOT_PARSE_OK) {
+        EXPECT_TRUE(lazy_walk(phot_doc_root(doc)) > 0);
+        EXPECT_TRUE(phot_doc_status(doc) != PHOT_PARSE_OK);
+    } else {
+        EXPECT_EQ_INT(ret, lazy_ret);
+    }
+    phot_free(&e);
+}
+
+static void test_lazy(void)
+{
+    const char *json = "{\"id\":7,\"name\":\"Hello\\nWorld\",\"skip\":[{\"a\":\"]}\\\"[{\"},[[[]]],-1.5e3],"
+                       "\"flag\":true,\"nested\":{\"list\":[1,\"two\",null]}}";
+    phot_doc doc;
+    phot_doc_init(&doc);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, json, strlen(json)));
+    phot_elem *root = phot_doc_root(&doc);
+    EXPECT_EQ_INT(PHOT_OBJ, phot_get_type(root));
+    EXPECT_EQ_SIZE_T(5, phot_get_obj_len(root));
+    // 只展开访问到的部分
+    phot_elem *skip = phot_find_obj_value(root, "skip", 4);
+    EXPECT_EQ_INT(PHOT_ARR, phot_get_type(skip));
+    EXPECT_TRUE(skip->flags & PHOT_FLAG_LAZY);
+    EXPECT_EQ_DOUBLE(7.0, phot_get_num(phot_find_obj_value(root, "id", 2)));
+    EXPECT_EQ_STR("Hello\nWorld", phot_get_str(phot_find_obj_value(root, "name", 4)), 11);
+    EXPECT_TRUE(phot_get_bool(phot_find_obj_value(root, "flag", 4)));
+    phot_elem *list = phot_find_obj_value(phot_find_obj_value(root, "nested", 6), "list", 4);
+    EXPECT_EQ_STR("two", phot_get_str(phot_get_arr_elem(list, 1)), 3);
+    EXPECT_TRUE(skip->flags & PHOT_FLAG_LAZY);
+    EXPECT_EQ_SIZE_T(3, phot_get_arr_len(skip));
+    EXPECT_EQ_STR("]}\"[{", phot_get_str(phot_find_obj_value(phot_get_arr_elem(skip, 0), "a", 1)), 5);
+    EXPECT_EQ_DOUBLE(-1.5e3, phot_get_num(phot_get_arr_elem(skip, 2)));
+    // 展开后照常修改，输出与立即解析的结果相同
+    phot_set_num(phot_push_arr(skip), 4.0);
+    EXPECT_EQ_SIZE_T(4, phot_get_arr_len(skip));
+    phot_free(root);
+    test_lazy_case(&doc, json, strlen(json));
+    phot_elem e;
+    phot_init(&e);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, json, strlen(json)));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, json));
+    char *s1 = phot_stringify(&e, NULL), *s2 = phot_stringify(phot_doc_root(&doc), NULL);
+    EXPECT_TRUE(strcmp(s1, s2) == 0);
+    free(s1);
+    free(s2);
+    phot_free(&e);
+
+    // 标量和括号不配对时直接完整解析，错误码与 phot_parse_doc 相同
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, " 1.5 ", 5));
+    EXPECT_EQ_DOUBLE(1.5, phot_get_num(phot_doc_root(&doc)));
+    EXPECT_EQ_INT(PHOT_PARSE_EXPECT_VALUE, phot_parse_lazy(&doc, "", 0));
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_QUOTATION_MARK, phot_parse_lazy(&doc, "[\"]", 3));
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, phot_parse_lazy(&doc, "[1,[2]", 6));
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, phot_parse_lazy(&doc, "[1 2] x", 7));
+    EXPECT_EQ_INT(PHOT_PARSE_ROOT_NOT_SINGULAR, phot_parse_lazy(&doc, "[1] x", 5));
+    EXPECT_EQ_INT(PHOT_NULL, phot_get_type(phot_doc_root(&doc)));
+
+    // 没有访问到的错误不会被发现，访问到时记在文档中，值变为零值
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, "[1.e5,\"\\x\",{\"k\" 1},[}]", 22));
+    root = phot_doc_root(&doc);
+    EXPECT_EQ_SIZE_T(4, phot_get_arr_len(root));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_doc_status(&doc));
+    EXPECT_EQ_DOUBLE(0.0, phot_get_num(phot_get_arr_elem(root, 0)));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_doc_status(&doc));
+    EXPECT_EQ_STR("", phot_get_str(phot_get_arr_elem(root, 1)), 0);
+    EXPECT_EQ_SIZE_T(0, phot_get_obj_len(phot_get_arr_elem(root, 2)));
+    EXPECT_EQ_SIZE_T(0, phot_get_arr_len(phot_get_arr_elem(root, 3)));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_doc_status(&doc));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, "{\"k\" 1}", 7));
+    EXPECT_EQ_SIZE_T(0, phot_get_obj_len(phot_doc_root(&doc)));
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COLON, phot_doc_status(&doc));
+
+    // 每个值在访问处都能用 phot_get_status 检查，出错的值重新赋值后恢复正常
+    static const char bad[] = "[1.e5,\"\\x\",{\"k\" 1},\"ok\",2,[}]";
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, bad, sizeof(bad) - 1));
+    root = phot_doc_root(&doc);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(root));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_get_status(phot_get_arr_elem(root, 0)));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_STR_ESCAPE, phot_get_status(phot_get_arr_elem(root, 1)));
+    EXPECT_EQ_STR("", phot_get_str(phot_get_arr_elem(root, 1)), 0);
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COLON, phot_get_status(phot_get_arr_elem(root, 2)));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(phot_get_arr_elem(root, 3)));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(phot_get_arr_elem(root, 4)));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_get_status(phot_get_arr_elem(root, 5)));
+    EXPECT_EQ_INT(PHOT_PARSE_INVALID_VALUE, phot_doc_status(&doc));
+    phot_elem copy;
+    phot_init(&copy);
+    phot_copy(&copy, phot_get_arr_elem(root, 0));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(&copy));
+    phot_set_num(phot_get_arr_elem(root, 0), 3.0);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(phot_get_arr_elem(root, 0)));
+    phot_set_str(phot_get_arr_elem(root, 1), "x", 1);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_get_status(phot_get_arr_elem(root, 1)));
+    phot_free(root);
+
+    // 跨越多个 64 字节块的深层嵌套和长字符串，反斜杠序列和括号落在块边界两侧
+    char *big = (char *)malloc(1 << 16);
+    char *p = big;
+    p += sprintf(p, "{\"deep\":");
+    for (int i = 0; i < 100; i++) {
+        p += sprintf(p, i % 2 ? "{\"k%d\":" : "[", i);
+    }
+    p += sprintf(p, "0");
+    for (int i = 99; i >= 0; i--) {
+        *p++ = i % 2 ? '}' : ']';
+    }
+    p += sprintf(p, ",\"strs\":[");
+    for (int i = 0; i < 6; i++) {
+        *p++ = '"';
+        for (int j = 0; j < 1000; j++) {
+            if (j % 61 < i + 1) {
+                *p++ = '\\';
+                *p++ = j % 61 == i ? '"' : '\\';
+            } else {
+                *p++ = "ab[]{}"[j % 6];
+            }
+        }
+        p += sprintf(p, "\",");
+    }
+    strcpy(p, "{}],\"last\":[1,2,3]}");
+    size_t len = strlen(big);
+    static const char alphabet[] = "{}[]:,\"\\ \tabefnlrstu0123456789.-+eEx\0";
+    uint64_t state = 88172645463325252ULL;
+    char *buf = (char *)malloc(len);
+    static const phot_simd levels[] = {PHOT_SIMD_SCALAR, PHOT_SIMD_AVX2};
+    for (size_t i = 0; i < 2; i++) {
+        phot_set_simd(levels[i]);
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, big, len));
+        phot_elem *last = phot_find_obj_value(phot_doc_root(&doc), "last", 4);
+        EXPECT_EQ_DOUBLE(3.0, phot_get_num(phot_get_arr_elem(last, 2)));
+        test_lazy_case(&doc, big, len);
+        // 随机修改若干字节，与立即解析的结果对比
+        for (int round = 0; round < 2000; round++) {
+            size_t n = len;
+            memcpy(buf, big, len);
+            for (int k = 0; k < 1 + round % 3; k++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                size_t pos = (state >> 8) % n;
+                buf[pos] = alphabet[(state >> 40) % (sizeof(alphabet) - 1)];
+                if (round % 5 == 0) {
+                    n = pos + 1;  // 截断
+                }
+            }
+            test_lazy_case(&doc, buf, n);
+        }
+    }
+    phot_set_simd(PHOT_SIMD_AVX2);
+    free(buf);
+    free(big);
+    phot_doc_free(&doc);
+}
+
+// NDJSON 的回调记录每条记录的结果，并发回调时各条记录写入各自的位置
+typedef struct {
+    size_t count;          // 期望的记录数
+    const size_t *offsets;  // 期望的记录偏移，递增
+    int *status;
+    double *ids;
+    int *seen;         // 每条记录被回调的次数
+    size_t delivered;  // 有序交付时已回调的条数
+    bool in_order;     // 有序交付时偏移是否依次出现
+    size_t limit;      // 回调到第 limit 条时中止
+} ndjson_recorder;
+
+static bool ndjson_record(void *ud, size_t offset, int status, const phot_elem *e)
+{
+    ndjson_recorder *r = (ndjson_recorder *)ud;
+    size_t lo = 0, hi = r->count;
+    while (lo + 1 < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (r->offsets[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    r->status[lo] = status;
+    r->ids[lo] = status == PHOT_PARSE_OK ? phot_get_num(phot_find_obj_value(e, "id", 2)) : -1.0;
+    r->seen[lo]++;
+    return lo + 1 != r->limit;
+}
+
+static bool ndjson_record_ordered(void *ud, size_t offset, int status, const phot_elem *e)
+{
+    ndjson_recorder *r = (ndjson_recorder *)ud;
+    r->in_order &= r->delivered < r->count && r->offsets[r->delivered] == offset;
+    r->delivered++;
+    return ndjson_record(ud, offset, status, e);
+}
+
+static void test_ndjson(void)
+{
+    // 多于一批的输入，夹杂错误记录、空白行和 CRLF，最后一行没有换行
+    size_t n = 40000;
+    char *json = (char *)malloc(n * 96);
+    size_t *offsets = (size_t *)malloc(n * sizeof(size_t));
+    int *status = (int *)malloc(n * sizeof(int));
+    size_t count = 0;
+    char *p = json;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 11 == 0) {
+            p += sprintf(p, i % 2 ? "\n" : "  \r\n");
+            continue;
+        }
+        offsets[count] = p - json;
+        const char *line = p;
+        if (i % 7 == 0) {
+            p += sprintf(p, "{\"id\":%zu,", i);
+        } else {
+            p += sprintf(p, "{\"id\":%zu,\"s\":\"line\\t%zu\",\"attribute_key_%02zu\":[1,2]}", i, i, i % 10);
+        }
+        phot_elem e;
+        phot_init(&e);
+        status[count++] = phot_parse_n(&e, line, p - line);
+        phot_free(&e);
+        p += sprintf(p, i % 3 == 0 ? "\r\n" : "\n");
+    }
+    offsets[count] = p - json;
+    status[count++] = PHOT_PARSE_OK;
+    p += sprintf(p, "{\"id\":%zu}", n);
+    size_t len = p - json;
+
+    ndjson_recorder r;
+    r.count = count;
+    r.offsets = offsets;
+    r.status = (int *)malloc(count * sizeof(int));
+    r.ids = (double *)malloc(count * sizeof(double));
+    r.seen = (int *)malloc(count * sizeof(int));
+    static const size_t threads[] = {1, 4};
+    phot_intern *keys = phot_intern_new(0);
+    for (size_t t = 0; t < 2; t++) {
+        for (int ordered = 0; ordered <= 1; ordered++) {
+            // 多线程时共享同一个驻留表
+            phot_ndjson_opts opts = {threads[t], ordered, t == 1 ? keys : NULL, NULL};
+            memset(r.seen, 0, count * sizeof(int));
+            r.delivered = 0;
+            r.in_order = true;
+            r.limit = 0;
+            EXPECT_EQ_INT(PHOT_PARSE_OK,
+                          phot_parse_ndjson(json, len, &opts, ordered ? ndjson_record_ordered : ndjson_record, &r));
+            bool ok = true;
+            for (size_t i = 0; i < count; i++) {
+                ok &= r.seen[i] == 1 && r.status[i] == status[i];
+                if (status[i] == PHOT_PARSE_OK) {
+                    ok &= r.ids[i] == strtod(json + offsets[i] + 6, NULL);
+                }
+            }
+            EXPECT_TRUE(ok);
+            EXPECT_TRUE(r.in_order);
+            if (ordered) {
+                EXPECT_EQ_SIZE_T(count, r.delivered);
+            }
+
+            // 有序交付时中止后不会再有回调
+            memset(r.seen, 0, count * sizeof(int));
+            r.delivered = 0;
+            r.limit = count / 2;
+            EXPECT_EQ_INT(PHOT_PARSE_ABORTED,
+                          phot_parse_ndjson(json, len, &opts, ordered ? ndjson_record_ordered : ndjson_record, &r));
+            if (ordered) {
+                EXPECT_EQ_SIZE_T(count / 2, r.delivered);
+                EXPECT_TRUE(r.in_order);
+            }
+        }
+    }
+    phot_intern_stats stats;
+    phot_intern_get_stats(keys, &stats);
+    EXPECT_EQ_SIZE_T(10, stats.keys);
+    EXPECT_TRUE(stats.hits > 0 && stats.hits + 10 == stats.lookups);
+    phot_intern_free(keys);
+    r.limit = 0;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_ndjson("", 0, NULL, ndjson_record, &r));
+    free(r.status);
+    free(r.ids);
+    free(r.seen);
+    free(json);
+    free(offsets);
+    free(status);
+}
+
+// 驻留的长键在多次解析之间共享，短键照样存放在成员内
+static void test_intern(void)
+{
+    static const char json[] = "{\"a\":1,\"long_key_name\":{\"long_key_name\":2},\"another_long_key\":3}";
+    phot_intern *keys = phot_intern_new(0);
+    phot_intern_stats stats;
+    phot_elem e1, e2, copy;
+    phot_doc doc;
+    phot_init(&e1);
+    phot_init(&e2);
+    phot_init(&copy);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_intern(&e1, json, sizeof(json) - 1, keys));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_intern(&e2, json, sizeof(json) - 1, keys));
+    EXPECT_TRUE(phot_is_equal(&e1, &e2));
+    const char *k = phot_intern_key(keys, "long_key_name", 13);
+    EXPECT_TRUE(k == phot_get_obj_key(&e1, 1));
+    EXPECT_TRUE(k == phot_get_obj_key(&e2, 1));
+    EXPECT_TRUE(k == phot_get_obj_key(phot_get_obj_value(&e1, 1), 0));
+    EXPECT_TRUE(phot_get_obj_key(&e1, 0) != phot_get_obj_key(&e2, 0));
+    EXPECT_EQ_STR("another_long_key", phot_get_obj_key(&e2, 2), phot_get_obj_key_len(&e2, 2));
+    EXPECT_EQ_SIZE_T(1, phot_find_obj_index(&e1, k, 13));
+    EXPECT_EQ_SIZE_T(2, phot_find_obj_index(&e1, "another_long_key", 16));
+    phot_intern_get_stats(keys, &stats);
+    EXPECT_EQ_SIZE_T(2, stats.keys);
+    EXPECT_EQ_SIZE_T(31, stats.bytes);
+    EXPECT_EQ_SIZE_T(7, stats.lookups);
+    EXPECT_EQ_SIZE_T(5, stats.hits);
+    EXPECT_EQ_SIZE_T(14 * 4 + 17, stats.saved);
+
+    // 插入的长键同样共享，文档和惰性文档挂上驻留表后也一样
+    phot_set_num(phot_set_obj_value_intern(&e2, "yet_another_key", 15, keys), 4.0);
+    EXPECT_TRUE(phot_intern_key(keys, "yet_another_key", 15) == phot_get_obj_key(&e2, 3));
+    phot_doc_init(&doc);
+    doc.keys = keys;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+    EXPECT_TRUE(k == phot_get_obj_key(phot_doc_root(&doc), 1));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, json, sizeof(json) - 1));
+    EXPECT_TRUE(k == phot_get_obj_key(phot_get_obj_value(phot_doc_root(&doc), 1), 0));
+    phot_doc_free(&doc);
+
+    // 副本自己持有键，驻留表释放后仍然有效
+    phot_copy(&copy, &e2);
+    phot_free(&e1);
+    phot_free(&e2);
+    phot_intern_free(keys);
+    EXPECT_EQ_STR("long_key_name", phot_get_obj_key(&copy, 1), phot_get_obj_key_len(&copy, 1));
+    phot_free(&copy);
+
+    // 表满后未命中的键照常分配
+    keys = phot_intern_new(1);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_intern(&e1, json, sizeof(json) - 1, keys));
+    EXPECT_TRUE(phot_intern_key(keys, "long_key_name", 13) == phot_get_obj_key(&e1, 1));
+    EXPECT_TRUE(phot_intern_key(keys, "another_long_key", 16) == NULL);
+    EXPECT_EQ_STR("another_long_key", phot_get_obj_key(&e1, 2), phot_get_obj_key_len(&e1, 2));
+    phot_free(&e1);
+    phot_intern_free(keys);
 }
 
 static void test_access_null(void)
@@ -571,6 +1982,57 @@ static void test_access_str(void)
     phot_free(&e);
 }
 
+// 不超过 12 字节的字符串和键存放在元素内，其余在堆上
+static void test_access_sso(void)
+{
+    static const char *strs[] = {"", "a", "Hello\0World", "123456789012", "1234567890123", "a much longer string value"};
+    phot_elem e, o, copy;
+    size_t i, len;
+    phot_init(&e);
+    phot_init(&o);
+    phot_init(&copy);
+    phot_set_obj(&o, 0);
+    for (i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+        len = i == 2 ? 11 : strlen(strs[i]);
+        phot_set_str(&e, strs[i], len);
+        EXPECT_EQ_SIZE_T(len, phot_get_str_len(&e));
+        EXPECT_TRUE(memcmp(strs[i], phot_get_str(&e), len) == 0);
+        EXPECT_TRUE(phot_get_str(&e)[len] == '\0');
+        EXPECT_EQ_INT(len <= 12, (const char *)&e == phot_get_str(&e));
+        phot_set_str(phot_set_obj_value(&o, strs[i], len), strs[i], len);
+        EXPECT_EQ_SIZE_T(len, phot_get_obj_key_len(&o, i));
+        EXPECT_TRUE(memcmp(strs[i], phot_get_obj_key(&o, i), len) == 0);
+        EXPECT_TRUE(phot_get_obj_key(&o, i)[len] == '\0');
+    }
+    EXPECT_EQ_SIZE_T(2, phot_find_obj_index(&o, "Hello\0World", 11));
+    EXPECT_TRUE(phot_find_obj_value(&o, "Hello", 5) == NULL);
+    phot_copy(&copy, &o);
+    EXPECT_TRUE(phot_is_equal(&copy, &o));
+    phot_set_str(&e, "123456789012", 12);
+    EXPECT_TRUE(phot_is_equal(&e, phot_find_obj_value(&copy, "123456789012", 12)));
+    EXPECT_TRUE(!phot_is_equal(&e, phot_find_obj_value(&copy, "1234567890123", 13)));
+
+    // 键来自对象自己的短字符串值，插入时扩容也不能让它失效
+    phot_shrink_obj(&o);
+    phot_set_num(phot_set_obj_value(&o, phot_get_str(phot_get_obj_value(&o, 1)), 1), 1.0);
+    EXPECT_EQ_SIZE_T(1, phot_find_obj_index(&o, "a", 1));
+    phot_set_str(phot_get_obj_value(&o, 1), "b", 1);
+    phot_set_num(phot_set_obj_value(&o, phot_get_str(phot_get_obj_value(&o, 1)), 1), 2.0);
+    EXPECT_EQ_SIZE_T(7, phot_get_obj_len(&o));
+    EXPECT_EQ_STR("b", phot_get_obj_key(&o, 6), phot_get_obj_key_len(&o, 6));
+
+    // 解析出的短字符串和键同样存放在元素内
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, "{\"123456789012\":\"ab\",\"1234567890123\":\"\\u20AC\"}"));
+    EXPECT_EQ_STR("123456789012", phot_get_obj_key(&e, 0), phot_get_obj_key_len(&e, 0));
+    EXPECT_EQ_STR("1234567890123", phot_get_obj_key(&e, 1), phot_get_obj_key_len(&e, 1));
+    EXPECT_EQ_STR("ab", phot_get_str(phot_get_obj_value(&e, 0)), 2);
+    EXPECT_EQ_STR("\xE2\x82\xAC", phot_get_str(phot_get_obj_value(&e, 1)), 3);
+    EXPECT_TRUE(phot_get_str(phot_get_obj_value(&e, 0)) == (const char *)phot_get_obj_value(&e, 0));
+    phot_free(&e);
+    phot_free(&o);
+    phot_free(&copy);
+}
+
 static void test_access_arr(void)
 {
     phot_elem a, e;
@@ -711,14 +2173,399 @@ static void test_access_obj(void)
     phot_free(&o);
 }
 
+// 超过索引阈值的大对象：插入、查找、删除、清空、复制、比较以及文档模式
+static void test_access_obj_index(void)
+{
+    enum { N = 10000 };
+    phot_elem o, o2;
+    phot_doc doc;
+    char key[16];
+    size_t i, klen;
+
+    phot_init(&o);
+    phot_set_obj(&o, 0);
+    for (i = 0; i < N; i++) {
+        klen = sprintf(key, "id%zu", i);
+        phot_set_num(phot_set_obj_value(&o, key, klen), (double)i);
+    }
+    phot_set_num(phot_set_obj_value(&o, "id42", 4), -42.0);  // 已存在的键不会重复添加
+    EXPECT_EQ_SIZE_T(N, phot_get_obj_len(&o));
+    for (i = 0; i < N; i += 7) {
+        klen = sprintf(key, "id%zu", i);
+        EXPECT_EQ_SIZE_T(i, phot_find_obj_index(&o, key, klen));
+    }
+    EXPECT_EQ_DOUBLE(-42.0, phot_get_num(phot_find_obj_value(&o, "id42", 4)));
+    EXPECT_TRUE(phot_find_obj_value(&o, "id", 2) == NULL);
+    EXPECT_TRUE(phot_find_obj_value(&o, "id10000", 7) == NULL);
+
+    phot_remove_obj_member(&o, phot_find_obj_index(&o, "id0", 3));
+    EXPECT_TRUE(phot_find_obj_value(&o, "id0", 3) == NULL);
+    EXPECT_EQ_SIZE_T(N - 2, phot_find_obj_index(&o, "id9999", 6));
+    phot_set_num(phot_set_obj_value(&o, "id0", 3), 0.0);
+    EXPECT_EQ_SIZE_T(N - 1, phot_find_obj_index(&o, "id0", 3));
+
+    // 逆序复制，比较时成员顺序不同也应相等
+    phot_init(&o2);
+    phot_set_obj(&o2, 0);
+    for (i = N; i-- > 0;) {
+        phot_copy(phot_set_obj_value(&o2, phot_get_obj_key(&o, i), phot_get_obj_key_len(&o, i)),
+                  phot_get_obj_value(&o, i));
+    }
+    EXPECT_TRUE(phot_is_equal(&o, &o2));
+    phot_set_num(phot_find_obj_value(&o2, "id1234", 6), 0.5);
+    EXPECT_TRUE(!phot_is_equal(&o, &o2));
+    phot_free(&o2);
+
+    phot_clear_obj(&o);
+    EXPECT_TRUE(phot_find_obj_value(&o, "id1", 3) == NULL);
+    phot_set_num(phot_set_obj_value(&o, "id1", 3), 1.0);
+    EXPECT_EQ_SIZE_T(0, phot_find_obj_index(&o, "id1", 3));
+
+    // 文档里的大对象在解析时建立索引，重复的键取第一个
+    size_t json_len;
+    phot_set_obj(&o, 0);
+    for (i = 0; i < N; i++) {
+        klen = sprintf(key, "k%zu", i);
+        phot_set_num(phot_set_obj_value(&o, key, klen), (double)i);
+    }
+    char *json = phot_stringify(&o, &json_len);
+    json[json_len - 1] = ',';
+    json = (char *)realloc(json, json_len + 16);
+    strcpy(json + json_len, "\"k5\":-5}");
+    phot_doc_init(&doc);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, json));
+    EXPECT_EQ_SIZE_T(N + 1, phot_get_obj_len(phot_doc_root(&doc)));
+    EXPECT_EQ_DOUBLE(5.0, phot_get_num(phot_find_obj_value(phot_doc_root(&doc), "k5", 2)));
+    EXPECT_EQ_DOUBLE(9999.0, phot_get_num(phot_find_obj_value(phot_doc_root(&doc), "k9999", 5)));
+    phot_remove_obj_member(phot_doc_root(&doc), 0);
+    EXPECT_TRUE(phot_find_obj_value(phot_doc_root(&doc), "k0", 2) == NULL);
+    phot_set_num(phot_set_obj_value(phot_doc_root(&doc), "new", 3), 1.0);
+    EXPECT_EQ_SIZE_T(N + 1, phot_get_obj_len(phot_doc_root(&doc)));
+    EXPECT_EQ_SIZE_T(N, phot_find_obj_index(phot_doc_root(&doc), "new", 3));
+    EXPECT_EQ_SIZE_T(0, phot_find_obj_index(phot_doc_root(&doc), "k1", 2));
+    phot_free(phot_doc_root(&doc));
+    phot_doc_free(&doc);
+    free(json);
+
+    phot_free(&o);
+}
+
+#if TEST_THREADS
+// 每个线程查找全部的键，记下结果不对的次数
+typedef struct {
+    const phot_elem *obj;
+    size_t n;
+    size_t miss;
+} lookup_job;
+
+static void *lookup_worker(void *arg)
+{
+    lookup_job *job = (lookup_job *)arg;
+    char key[32];
+    for (int round = 0; round < 8; round++) {
+        for (size_t i = 0; i < job->n; i++) {
+            size_t klen = sprintf(key, "k%zu", i);
+            const phot_elem *v = phot_find_obj_value(job->obj, key, klen);
+            if (v == NULL || phot_get_num(v) != (double)i) {
+                job->miss++;
+            }
+        }
+    }
+    return NULL;
+}
+#endif
+
+// 查找不修改对象，解析得到的大对象可以由多个线程同时查找
+static void test_access_obj_index_shared(void)
+{
+#if TEST_THREADS
+    enum { N = 2000, T = 4 };
+    phot_elem o, parsed;
+    pthread_t tid[T];
+    lookup_job jobs[T];
+    char key[16];
+    size_t i, klen, json_len;
+
+    phot_init(&o);
+    phot_set_obj(&o, 0);
+    for (i = 0; i < N; i++) {
+        klen = sprintf(key, "k%zu", i);
+        phot_set_num(phot_set_obj_value(&o, key, klen), (double)i);
+    }
+    char *json = phot_stringify(&o, &json_len);
+    phot_init(&parsed);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&parsed, json));
+    const phot_elem *objs[] = {&o, &parsed};
+    for (size_t k = 0; k < 2; k++) {
+        for (int t = 0; t < T; t++) {
+            jobs[t].obj = objs[k];
+            jobs[t].n = N;
+            jobs[t].miss = 0;
+            EXPECT_EQ_INT(0, pthread_create(&tid[t], NULL, lookup_worker, &jobs[t]));
+        }
+        for (int t = 0; t < T; t++) {
+            pthread_join(tid[t], NULL);
+            EXPECT_EQ_SIZE_T(0, jobs[t].miss);
+        }
+    }
+    phot_free(&parsed);
+    phot_free(&o);
+    free(json);
+#endif
+}
+
+// 长度和容量超过 32 位时拒绝修改，元素保持原样，而不是截断后写进去
+static void test_access_too_long(void)
+{
+#if SIZE_MAX > UINT32_MAX
+    const size_t too_long = (size_t)UINT32_MAX + 1;
+    phot_elem e;
+    phot_init(&e);
+    phot_set_str(&e, "abc", 3);
+    EXPECT_TRUE(!phot_set_str(&e, "abc", too_long));
+    EXPECT_TRUE(!phot_set_arr(&e, too_long));
+    EXPECT_TRUE(!phot_set_obj(&e, too_long));
+    EXPECT_EQ_INT(PHOT_STR, phot_get_type(&e));
+    EXPECT_EQ_STR("abc", phot_get_str(&e), phot_get_str_len(&e));
+
+    EXPECT_TRUE(phot_set_arr(&e, 2));
+    EXPECT_TRUE(!phot_reserve_arr(&e, too_long));
+    EXPECT_EQ_SIZE_T(2, phot_get_arr_cap(&e));
+    EXPECT_TRUE(phot_reserve_arr(&e, 4));
+    EXPECT_EQ_SIZE_T(4, phot_get_arr_cap(&e));
+
+    EXPECT_TRUE(phot_set_obj(&e, 2));
+    EXPECT_TRUE(!phot_reserve_obj(&e, too_long));
+    EXPECT_EQ_SIZE_T(2, phot_get_obj_cap(&e));
+    EXPECT_TRUE(phot_set_obj_value(&e, "abc", too_long) == NULL);
+    EXPECT_EQ_SIZE_T(0, phot_get_obj_len(&e));
+    phot_free(&e);
+#endif
+}
+
 static void test_access(void)
 {
     test_access_null();
     test_access_bool();
     test_access_num();
     test_access_str();
+    test_access_sso();
     test_access_arr();
     test_access_obj();
+    test_access_obj_index();
+    test_access_obj_index_shared();
+    test_access_too_long();
+}
+
+// 记录每块内存请求的大小，检查库在 realloc 和 free 时交回的大小是否一致
+#define TRACK_MAX 1024
+
+typedef struct {
+    void *ptr[TRACK_MAX];
+    size_t size[TRACK_MAX];
+    size_t live, allocs, bad_sizes, unknown_sizes;
+} alloc_tracker;
+
+static size_t track_find(const alloc_tracker *t, const void *ptr)
+{
+    for (size_t i = 0; i < t->live; i++) {
+        if (t->ptr[i] == ptr) return i;
+    }
+    return TRACK_MAX;
+}
+
+static void *track_alloc(void *ctx, size_t size)
+{
+    alloc_tracker *t = (alloc_tracker *)ctx;
+    if (t->live == TRACK_MAX) return NULL;
+    void *ptr = malloc(size);
+    t->ptr[t->live] = ptr;
+    t->size[t->live++] = size;
+    t->allocs++;
+    return ptr;
+}
+
+static void *track_realloc(void *ctx, void *ptr, size_t old_size, size_t size)
+{
+    alloc_tracker *t = (alloc_tracker *)ctx;
+    size_t i = track_find(t, ptr);
+    if (i == TRACK_MAX) {
+        t->bad_sizes++;
+        return NULL;
+    }
+    t->bad_sizes += t->size[i] != old_size;
+    t->ptr[i] = realloc(ptr, size);
+    t->size[i] = size;
+    t->allocs++;
+    return t->ptr[i];
+}
+
+static void track_free(void *ctx, void *ptr, size_t size)
+{
+    alloc_tracker *t = (alloc_tracker *)ctx;
+    size_t i = track_find(t, ptr);
+    if (i == TRACK_MAX) {
+        t->bad_sizes++;
+        return;
+    }
+    t->bad_sizes += size != 0 && size != t->size[i];
+    t->unknown_sizes += size == 0;
+    free(ptr);
+    t->live--;
+    t->ptr[i] = t->ptr[t->live];
+    t->size[i] = t->size[t->live];
+}
+
+static bool ndjson_count(void *ud, size_t offset, int status, const phot_elem *e)
+{
+    (void)offset;
+    (void)e;
+    *(size_t *)ud += status == PHOT_PARSE_OK;
+    return true;
+}
+
+static void test_reuse(void)
+{
+    static alloc_tracker heap;
+    phot_allocator a = {track_alloc, track_realloc, track_free, &heap};
+    char big[4096];
+    size_t n = 0;
+    big[n++] = '[';
+    for (int i = 0; i < 300; i++) {
+        n += sprintf(big + n, "%s\"str%d\"", i == 0 ? "" : ",", i);
+    }
+    big[n++] = ']';
+    big[n] = '\0';
+    const char *small = "{\"id\":7,\"tags\":[\"a\",\"b\"],\"ok\":true}";
+
+    // 解析栈跨调用保留，结果与 phot_parse_n 相同
+    phot_parser p;
+    phot_parser_init(&p);
+    phot_elem e, expect;
+    phot_init(&e);
+    phot_init(&expect);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_with(&p, &e, big, n));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&expect, big, n));
+    EXPECT_TRUE(phot_is_equal(&e, &expect));
+    phot_free(&e);
+    phot_free(&expect);
+    char *stack = p.stack;
+    size_t size = p.size;
+    EXPECT_TRUE(size >= 300 * sizeof(phot_elem));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_with(&p, &e, small, strlen(small)));
+        EXPECT_EQ_SIZE_T(3, phot_get_obj_len(&e));
+        phot_free(&e);
+    }
+    EXPECT_EQ_INT(PHOT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, phot_parse_with(&p, &e, "[1 2]", 5));
+    EXPECT_TRUE(p.stack == stack);
+    EXPECT_EQ_SIZE_T(size, p.size);
+
+    // 超过 trim 的解析栈在解析后缩回
+    p.trim = 512;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_with(&p, &e, big, n));
+    EXPECT_EQ_SIZE_T(300, phot_get_arr_len(&e));
+    EXPECT_EQ_SIZE_T(512, p.size);
+    phot_free(&e);
+    phot_parser_free(&p);
+    EXPECT_TRUE(p.stack == NULL);
+
+    // 预热之后的序列化不再分配
+    phot_set_allocator(&a);
+    phot_writer w;
+    phot_writer_init(&w);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_n(&e, big, n));
+    size_t len;
+    const char *json = phot_stringify_with(&w, &e, NULL, &len);
+    EXPECT_EQ_SIZE_T(n, len);
+    EXPECT_TRUE(memcmp(big, json, n + 1) == 0);
+    size_t allocs = heap.allocs;
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(phot_stringify_with(&w, &e, NULL, &len) == w.buf);
+    }
+    EXPECT_EQ_SIZE_T(allocs, heap.allocs);
+    phot_stringify_opts opts = {2, ' ', false, true};
+    char *pretty = phot_stringify_ex(&e, &opts, NULL);
+    EXPECT_TRUE(strcmp(pretty, phot_stringify_with(&w, &e, &opts, NULL)) == 0);
+    a.free(a.ctx, pretty, 0);
+    phot_free(&e);
+
+    // 超过 trim 的缓冲区在下一次序列化前缩回
+    w.trim = 256;
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, small));
+    json = phot_stringify_with(&w, &e, NULL, &len);
+    EXPECT_TRUE(len == strlen(small) && strcmp(small, json) == 0);
+    EXPECT_EQ_SIZE_T(256, w.size);
+    phot_free(&e);
+    phot_writer_free(&w);
+    EXPECT_EQ_SIZE_T(0, heap.live);
+    EXPECT_EQ_SIZE_T(0, heap.bad_sizes);
+    phot_set_allocator(NULL);
+}
+
+static void test_allocator(void)
+{
+    static alloc_tracker heap, arena;
+    phot_allocator a = {track_alloc, track_realloc, track_free, &heap};
+    phot_allocator b = {track_alloc, track_realloc, track_free, &arena};
+    phot_set_allocator(&a);
+    EXPECT_TRUE(phot_get_allocator()->ctx == &heap);
+
+    // 堆上的树：长键和长字符串、数组扩容与收缩、带索引的大对象、复制和序列化
+    phot_elem e, copy;
+    phot_init(&e);
+    phot_init(&copy);
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse(&e, "{\"a long key over sso\":[1,\"longer than twelve bytes\",{\"k\":null}]}"));
+    phot_elem *arr = phot_get_obj_value(&e, 0);
+    for (int i = 0; i < 100; i++) {
+        phot_set_num(phot_push_arr(arr), i);
+    }
+    phot_shrink_arr(arr);
+    phot_elem *obj = phot_set_obj_value(&e, "wide", 4);
+    phot_set_obj(obj, 0);
+    for (int i = 0; i < 40; i++) {
+        char key[16];
+        int n = sprintf(key, "key%d", i);
+        phot_set_str(phot_set_obj_value(obj, key, n), "a value that lives on the heap", 30);
+    }
+    EXPECT_EQ_SIZE_T(39, phot_find_obj_index(obj, "key39", 5));
+    phot_remove_obj_member(obj, 0);
+    phot_shrink_obj(obj);
+    phot_copy(&copy, &e);
+    EXPECT_TRUE(phot_is_equal(&e, &copy));
+    char *json = phot_stringify(&e, NULL);
+    a.free(a.ctx, json, 0);
+    phot_free(&e);
+    phot_free(&copy);
+    EXPECT_TRUE(heap.allocs > 100);
+    EXPECT_EQ_SIZE_T(0, heap.live);
+    EXPECT_EQ_SIZE_T(0, heap.bad_sizes);
+    EXPECT_EQ_SIZE_T(1, heap.unknown_sizes);
+
+    // 文档和 NDJSON 的各线程文档使用自己的分配器，不经过全局的分配器
+    memset(&heap, 0, sizeof(heap));
+    phot_doc doc;
+    phot_doc_init(&doc);
+    doc.alloc = &b;
+    const char *text = "{\"escaped \\\"key\\\" over sso\":[\"a string with \\n escapes\",[1,2,3]],\"n\":null}";
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_doc(&doc, text));
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_lazy(&doc, text, strlen(text)));
+    EXPECT_EQ_SIZE_T(2, phot_get_arr_len(phot_get_obj_value(&doc.root, 0)));
+    EXPECT_EQ_SIZE_T(23, phot_get_str_len(phot_get_arr_elem(phot_get_obj_value(&doc.root, 0), 0)));
+    phot_doc_free(&doc);
+    size_t ok = 0;
+    phot_ndjson_opts opts = {1, true, NULL, &b};
+    const char *lines = "{\"id\":1}\n[\"a string longer than sso\"]\n{\"id\":\n";
+    EXPECT_EQ_INT(PHOT_PARSE_OK, phot_parse_ndjson(lines, strlen(lines), &opts, ndjson_count, &ok));
+    EXPECT_EQ_SIZE_T(2, ok);
+    EXPECT_EQ_SIZE_T(0, heap.allocs);
+    EXPECT_TRUE(arena.allocs > 0);
+    EXPECT_EQ_SIZE_T(0, arena.live);
+    EXPECT_EQ_SIZE_T(0, arena.bad_sizes);
+    EXPECT_EQ_SIZE_T(0, arena.unknown_sizes);
+
+    phot_set_allocator(NULL);
+    EXPECT_TRUE(phot_get_allocator()->ctx == NULL);
 }
 
 int main(void)
@@ -730,7 +2577,13 @@ int main(void)
     test_move();
     test_swap();
     test_file();
+    test_doc();
+    test_lazy();
+    test_ndjson();
+    test_intern();
     test_access();
+    test_allocator();
+    test_reuse();
     printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
     return main_ret;
 }